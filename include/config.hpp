@@ -16,10 +16,60 @@
 #define cfg_constexpr14
 #endif
 
-#if cfg_HAS_CONSTEXPR14 && defined(__clang__)
+#if defined(__cpp_consteval) && __cpp_consteval >= 201811
+#define cfg_HAS_CONSTEVAL 1
+#define cfg_consteval consteval
+#else
+#define cfg_HAS_CONSTEVAL 0
+#define cfg_consteval constexpr
+#endif
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911
+#define cfg_HAS_CLASS_NTTP 1
+#else
+#define cfg_HAS_CLASS_NTTP 0
+#endif
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define cfg_HAS_EXCEPTIONS 1
+#else
+#define cfg_HAS_EXCEPTIONS 0
+#endif
+
+#if cfg_HAS_CONSTEXPR14 && defined(__clang__) && cfg_HAS_EXCEPTIONS
 #define cfg_HAS_FULL_FEATURED_CONSTEXPR14 1
 #else
 #define cfg_HAS_FULL_FEATURED_CONSTEXPR14 0
 #endif
 
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define cfg_HAS_IS_CONSTANT_EVALUATED 1
+#endif
+#endif
+
+#if !defined(cfg_HAS_IS_CONSTANT_EVALUATED)
+#if (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9) || \
+    (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define cfg_HAS_IS_CONSTANT_EVALUATED 1
+#else
+#define cfg_HAS_IS_CONSTANT_EVALUATED 0
+#endif
+#endif
+
+#if !defined(cfg_HAS_X86_SIMD)
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) || \
+    (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define cfg_HAS_X86_SIMD 1
+#else
+#define cfg_HAS_X86_SIMD 0
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define cfg_TARGET(isa) __attribute__((target(isa)))
+#else
+#define cfg_TARGET(isa)
+#endif
+
 #endif  // CONFIG_HPP
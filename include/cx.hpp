@@ -16,6 +16,7 @@
 #include "cx/iterator.hpp"
 #include "cx/string_view.hpp"
 #include "cx/tuple.hpp"
+#include "cx/type_traits.hpp"
 #include "cx/utility.hpp"
 
 #endif  // CX_HPP
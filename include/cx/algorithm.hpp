@@ -6,13 +6,52 @@
 #ifndef CX_ALGORITHM_HPP
 #define CX_ALGORITHM_HPP
 
-#include "config.hpp"  // cfg_HAS_CONSTEXPR14
+#include <cstddef>      // std::ptrdiff_t, std::size_t
+#include <cstring>      // std::memchr, std::memcmp
+#include <type_traits>  // std::false_type, std::integral_constant, std::is_integral,
+                        // std::is_pointer, std::is_same, std::remove_cv, std::remove_pointer,
+                        // std::true_type
+
+#include "config.hpp"           // cfg_HAS_CONSTEXPR14
+#include "cx/type_traits.hpp"  // cx::is_constant_evaluated
 
 namespace cx
 {
 
+namespace detail
+{
+
+#if !cfg_HAS_CONSTEXPR14
+
+// The C++11 recursion is as deep as the evaluation is long, so the ranges are halved rather than
+// stepped over one item at a time.
+
 template <typename Iterator1, typename Iterator2>
-constexpr bool equal(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2)
+constexpr bool equal_n(Iterator1 first1, Iterator2 first2, std::ptrdiff_t n)
+{
+  return n <= 1 ? n == 0 || *first1 == *first2
+                : equal_n(first1, first2, n / 2) &&
+                      equal_n(first1 + n / 2, first2 + n / 2, n - n / 2);
+}
+
+#endif  // !cfg_HAS_CONSTEXPR14
+
+// Pointers to the same integral type can be compared by std::memcmp.
+template <typename Iterator1, typename Iterator2>
+struct is_memory_comparison
+    : std::integral_constant<
+          bool, std::is_pointer<Iterator1>::value && std::is_pointer<Iterator2>::value &&
+                    std::is_same<typename std::remove_cv<
+                                     typename std::remove_pointer<Iterator1>::type>::type,
+                                 typename std::remove_cv<
+                                     typename std::remove_pointer<Iterator2>::type>::type>::value &&
+                    std::is_integral<typename std::remove_cv<
+                        typename std::remove_pointer<Iterator1>::type>::type>::value>
+{
+};
+
+template <typename Iterator1, typename Iterator2>
+constexpr bool equal_loop(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2)
 {
 #if cfg_HAS_CONSTEXPR14
 
@@ -25,13 +64,126 @@ constexpr bool equal(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterat
 
 #else  // !cfg_HAS_CONSTEXPR14
 
-  return first1 != last1 && first2 != last2 && *first1 == *first2
-             ? equal(first1 + 1, last1, first2 + 1, last2)
-             : first1 == last1 && first2 == last2;
+  return last1 - first1 == last2 - first2 && equal_n(first1, first2, last1 - first1);
 
 #endif  // cfg_HAS_CONSTEXPR14
 }
 
+template <typename Iterator1, typename Iterator2>
+inline bool equal_memory(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2)
+{
+  if (last1 - first1 != last2 - first2)
+  {
+    return false;
+  }
+
+  auto size = static_cast<std::size_t>(last1 - first1) * sizeof(*first1);
+
+  return size == 0 || std::memcmp(first1, first2, size) == 0;
+}
+
+template <typename Iterator1, typename Iterator2>
+constexpr bool equal(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2,
+                     std::true_type)
+{
+  return is_constant_evaluated() ? equal_loop(first1, last1, first2, last2)
+                                 : equal_memory(first1, last1, first2, last2);
+}
+
+template <typename Iterator1, typename Iterator2>
+constexpr bool equal(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2,
+                     std::false_type)
+{
+  return equal_loop(first1, last1, first2, last2);
+}
+
+}  // namespace detail
+
+template <typename Iterator1, typename Iterator2>
+constexpr bool equal(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2)
+{
+  return detail::equal(first1, last1, first2, last2,
+                       detail::is_memory_comparison<Iterator1, Iterator2>());
+}
+
+namespace detail
+{
+
+// Pointers to bytes can be searched by std::memchr.
+template <typename Iterator, typename T>
+struct is_byte_search
+    : std::integral_constant<
+          bool, std::is_pointer<Iterator>::value &&
+                    std::is_same<typename std::remove_cv<
+                                     typename std::remove_pointer<Iterator>::type>::type,
+                                 T>::value &&
+                    std::is_integral<T>::value && !std::is_same<T, bool>::value && sizeof(T) == 1>
+{
+};
+
+#if !cfg_HAS_CONSTEXPR14
+
+template <typename Iterator, typename T>
+constexpr Iterator find_loop(Iterator first, Iterator last, const T& value);
+
+template <typename Iterator, typename T>
+constexpr Iterator find_loop_right(Iterator middle, Iterator last, const T& value, Iterator left)
+{
+  return left != middle ? left : find_loop(middle, last, value);
+}
+
+#endif  // !cfg_HAS_CONSTEXPR14
+
+template <typename Iterator, typename T>
+constexpr Iterator find_loop(Iterator first, Iterator last, const T& value)
+{
+#if cfg_HAS_CONSTEXPR14
+
+  while (first != last && !(*first == value))
+  {
+    ++first;
+  }
+
+  return first;
+
+#else  // !cfg_HAS_CONSTEXPR14
+
+  return last - first <= 1 ? first == last || *first == value ? first : last
+                           : find_loop_right(first + (last - first) / 2, last, value,
+                                             find_loop(first, first + (last - first) / 2, value));
+
+#endif  // cfg_HAS_CONSTEXPR14
+}
+
+template <typename Iterator, typename T>
+inline Iterator find_byte(Iterator first, Iterator last, const T& value)
+{
+  auto it = std::memchr(first, static_cast<unsigned char>(value),
+                        static_cast<std::size_t>(last - first));
+
+  return it != nullptr ? static_cast<Iterator>(it) : last;
+}
+
+template <typename Iterator, typename T>
+constexpr Iterator find(Iterator first, Iterator last, const T& value, std::true_type)
+{
+  return is_constant_evaluated() ? find_loop(first, last, value) : find_byte(first, last, value);
+}
+
+template <typename Iterator, typename T>
+constexpr Iterator find(Iterator first, Iterator last, const T& value, std::false_type)
+{
+  return find_loop(first, last, value);
+}
+
+}  // namespace detail
+
+template <typename Iterator, typename T>
+constexpr Iterator find(Iterator first, Iterator last, const T& value)
+{
+  return detail::find(first, last, value, detail::is_byte_search<Iterator, T>());
+}
+
 }  // namespace cx
 
 #endif  // CX_ALGORITHM_HPP
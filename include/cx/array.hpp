@@ -7,9 +7,10 @@
 #define CX_ARRAY_HPP
 
 #include <cstddef>    // std::size_t
+#include <cstdlib>    // std::abort
 #include <stdexcept>  // std::out_of_range
 
-#include "config.hpp"        // cfg_constexpr14
+#include "config.hpp"        // cfg_HAS_EXCEPTIONS, cfg_constexpr14
 #include "cx/algorithm.hpp"  // cx::equal
 
 namespace cx
@@ -72,12 +73,20 @@ struct array
 
   constexpr const T& at(std::size_t pos) const
   {
+#if cfg_HAS_EXCEPTIONS
     return pos < size() ? data[pos] : throw std::out_of_range("The given position is out of range");
+#else
+    return pos < size() ? data[pos] : (std::abort(), data[0]);
+#endif
   }
 
   cfg_constexpr14 T& at(std::size_t pos)
   {
+#if cfg_HAS_EXCEPTIONS
     return pos < size() ? data[pos] : throw std::out_of_range("The given position is out of range");
+#else
+    return pos < size() ? data[pos] : (std::abort(), data[0]);
+#endif
   }
 
   T data[N > 0 ? N : 1];
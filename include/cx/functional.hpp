@@ -34,7 +34,8 @@ struct less<void>
 template <typename T>
 struct equal_to
 {
-  constexpr auto operator()(const T& lhs, const T& rhs) const -> decltype(lhs == rhs)
+  constexpr auto operator()(const T& lhs, const T& rhs) const noexcept(noexcept(lhs == rhs))
+      -> decltype(lhs == rhs)
   {
     return lhs == rhs;
   }
@@ -45,7 +46,8 @@ struct equal_to<void>
 {
   template <typename T, typename U>
   constexpr auto operator()(T&& lhs, U&& rhs) const
-      -> decltype(std::forward<T>(lhs) == std::forward<U>(rhs))
+      noexcept(noexcept(std::forward<T>(lhs) == std::forward<U>(rhs)))
+          -> decltype(std::forward<T>(lhs) == std::forward<U>(rhs))
   {
     return std::forward<T>(lhs) == std::forward<U>(rhs);
   }
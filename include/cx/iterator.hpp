@@ -54,6 +54,18 @@ constexpr bool empty(std::initializer_list<E> il)
   return il.size() == 0;
 }
 
+template <typename C>
+constexpr auto data(const C& c) -> decltype(c.data())
+{
+  return c.data();
+}
+
+template <typename T, std::size_t N>
+constexpr const T* data(const T (&array)[N])
+{
+  return &array[0];
+}
+
 template <typename C>
 constexpr auto begin(const C& c) -> decltype(c.begin())
 {
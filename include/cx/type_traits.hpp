@@ -0,0 +1,27 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef CX_TYPE_TRAITS_HPP
+#define CX_TYPE_TRAITS_HPP
+
+#include "config.hpp"  // cfg_HAS_IS_CONSTANT_EVALUATED
+
+namespace cx
+{
+
+// Returns true during constant evaluation. Where the compiler cannot tell, it conservatively
+// returns true so the callers always stay on their constexpr friendly path.
+constexpr bool is_constant_evaluated()
+{
+#if cfg_HAS_IS_CONSTANT_EVALUATED
+  return __builtin_is_constant_evaluated();
+#else
+  return true;
+#endif
+}
+
+}  // namespace cx
+
+#endif  // CX_TYPE_TRAITS_HPP
@@ -0,0 +1,25 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef WILDCARDS_HPP
+#define WILDCARDS_HPP
+
+#define WILDCARDS_VERSION_MAJOR 1
+#define WILDCARDS_VERSION_MINOR 5
+#define WILDCARDS_VERSION_PATCH 0
+
+#include "wildcards/batch.hpp"
+#include "wildcards/cards.hpp"
+#include "wildcards/dfa.hpp"
+#include "wildcards/fixed_matcher.hpp"
+#include "wildcards/match.hpp"
+#include "wildcards/matcher.hpp"
+#include "wildcards/memo.hpp"
+#include "wildcards/normalize.hpp"
+#include "wildcards/program.hpp"
+#include "wildcards/simd.hpp"
+#include "wildcards/utility.hpp"
+
+#endif  // WILDCARDS_HPP
@@ -0,0 +1,260 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef WILDCARDS_BATCH_HPP
+#define WILDCARDS_BATCH_HPP
+
+#include <cstddef>  // std::ptrdiff_t, std::size_t
+#include <cstdint>  // std::uint64_t, std::uint8_t
+
+#include "cx/array.hpp"           // cx::array
+#include "wildcards/program.hpp"  // wildcards::detail::bitmap_index, wildcards::detail::opcode,
+                                  // wildcards::detail::program, wildcards::detail::set_capacity,
+                                  // wildcards::detail::set_members_capacity
+
+namespace wildcards
+{
+
+namespace detail
+{
+
+// The number of the sequences matched at once, one per bit (lane) of a mask.
+constexpr std::size_t batch_lanes = 64;
+
+// The number of the positions a batch program can follow. The state past the last one is its end.
+constexpr std::size_t batch_position_capacity = 63;
+
+// Transposes the 8x8 bit matrix whose rows are the bytes of the given word, so the byte k of the
+// result holds the bits k of the bytes of the word.
+inline std::uint64_t transpose_bits(std::uint64_t x)
+{
+  auto t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aa;
+  x ^= t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000cccc0000cccc;
+  x ^= t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0;
+  x ^= t ^ (t << 28);
+
+  return x;
+}
+
+// A program without alternatives laid out for bit-sliced matching of a batch of byte sequences.
+// The positions are those of Shift-And, but each of them keeps the mask of the lanes which reached
+// it. The items of the lanes at the same offset are transposed to eight bit planes, so a literal
+// position tells the lanes whose item it matches by eight operations on the planes.
+class batch_program
+{
+ public:
+  template <typename PatternIterator>
+  batch_program(const program& prog, PatternIterator p)
+      : prog_{prog}, positions_{}, size_{0}, valid_{false}
+  {
+    if (!prog.valid() || prog.has_alt())
+    {
+      return;
+    }
+
+    for (std::size_t pc = 0; pc != prog.size(); ++pc)
+    {
+      const auto& in = prog[pc];
+
+      if (in.op == opcode::set && in.next == set_capacity)
+      {
+        return;
+      }
+
+      if (in.op == opcode::literal)
+      {
+        for (auto i = in.first; i != in.last; ++i)
+        {
+          if (!push(position{opcode::literal, static_cast<std::uint8_t>(bitmap_index(*(p + i))),
+                             0}))
+          {
+            return;
+          }
+        }
+      }
+      else if (!push(position{in.op, 0, in.next}))
+      {
+        return;
+      }
+    }
+
+    valid_ = true;
+  }
+
+  bool valid() const
+  {
+    return valid_;
+  }
+
+  // Returns the mask of the lanes whose sequences match, the lane i matching [s[i], send[i]).
+  template <typename SequenceIterator>
+  std::uint64_t run(const SequenceIterator* s, const SequenceIterator* send,
+                    std::size_t lanes) const
+  {
+    cx::array<std::uint64_t, batch_position_capacity + 1> state{};
+    cx::array<std::uint8_t, batch_lanes> items{};
+
+    state[0] = lanes < batch_lanes ? (std::uint64_t{1} << lanes) - 1 : ~std::uint64_t{0};
+    close_stars(state);
+
+    for (std::size_t offset = 0;; ++offset)
+    {
+      std::uint64_t active = 0;
+
+      for (std::size_t lane = 0; lane != lanes; ++lane)
+      {
+        auto remains = send[lane] - s[lane] > static_cast<std::ptrdiff_t>(offset);
+
+        items[lane] = remains ? static_cast<std::uint8_t>(bitmap_index(s[lane][offset])) : 0;
+        active |= static_cast<std::uint64_t>(remains) << lane;
+      }
+
+      std::uint64_t alive = 0;
+
+      for (std::size_t i = 0; i != size_; ++i)
+      {
+        alive |= state[i];
+      }
+
+      // The lanes which have items left but no state left do not match.
+      if ((alive & active) == 0)
+      {
+        return state[size_] & ~active;
+      }
+
+      cx::array<std::uint64_t, 8> planes{};
+
+      for (std::size_t group = 0; group != batch_lanes / 8; ++group)
+      {
+        std::uint64_t word = 0;
+
+        for (std::size_t i = 0; i != 8; ++i)
+        {
+          word |= std::uint64_t{items[group * 8 + i]} << (i * 8);
+        }
+
+        word = transpose_bits(word);
+
+        for (std::size_t k = 0; k != 8; ++k)
+        {
+          planes[k] |= ((word >> (k * 8)) & 0xff) << (group * 8);
+        }
+      }
+
+      // The lanes which have no items left keep their states, the others take a step.
+      for (auto i = size_; i != 0; --i)
+      {
+        const auto& pos = positions_[i - 1];
+        auto reached = state[i - 1] & active;
+        auto matched = reached & accepts(pos, planes, items, reached);
+
+        state[i] = (state[i] & ~active) | matched |
+                   (i != size_ && positions_[i].op == opcode::anything ? state[i] & active : 0);
+      }
+
+      state[0] = (state[0] & ~active) |
+                 (size_ != 0 && positions_[0].op == opcode::anything ? state[0] & active : 0);
+      close_stars(state);
+    }
+  }
+
+ private:
+  struct position
+  {
+    opcode op;
+    std::uint8_t item;
+    std::size_t bitmap;
+  };
+
+  bool push(const position& pos)
+  {
+    if (size_ == batch_position_capacity)
+    {
+      return false;
+    }
+
+    positions_[size_++] = pos;
+
+    return true;
+  }
+
+  // Returns the mask of the lanes whose item is the given one.
+  static std::uint64_t equal_lanes(std::uint8_t item, const cx::array<std::uint64_t, 8>& planes)
+  {
+    auto lanes = ~std::uint64_t{0};
+
+    for (std::size_t k = 0; k != 8; ++k)
+    {
+      lanes &= ((item >> k) & 1) != 0 ? planes[k] : ~planes[k];
+    }
+
+    return lanes;
+  }
+
+  // Returns the mask of the lanes whose item the position matches. A set of a few members is
+  // matched on the planes, any other set looks up the items of the reached lanes one by one.
+  std::uint64_t accepts(const position& pos, const cx::array<std::uint64_t, 8>& planes,
+                        const cx::array<std::uint8_t, batch_lanes>& items,
+                        std::uint64_t reached) const
+  {
+    if (pos.op == opcode::literal)
+    {
+      return equal_lanes(pos.item, planes);
+    }
+
+    if (pos.op != opcode::set)
+    {
+      return ~std::uint64_t{0};
+    }
+
+    const auto& bitmap = prog_.bitmap(pos.bitmap);
+    std::uint64_t lanes = 0;
+
+    if (bitmap.size() <= set_members_capacity)
+    {
+      for (std::size_t i = 0; i != bitmap.size(); ++i)
+      {
+        lanes |= equal_lanes(bitmap.members()[i], planes);
+      }
+
+      return lanes;
+    }
+
+    for (std::size_t lane = 0; reached != 0; ++lane, reached >>= 1)
+    {
+      if ((reached & 1) != 0 && bitmap.contains(items[lane]))
+      {
+        lanes |= std::uint64_t{1} << lane;
+      }
+    }
+
+    return lanes;
+  }
+
+  // Lets the lanes which reached an anything reach the following position too.
+  void close_stars(cx::array<std::uint64_t, batch_position_capacity + 1>& state) const
+  {
+    for (std::size_t i = 0; i != size_; ++i)
+    {
+      if (positions_[i].op == opcode::anything)
+      {
+        state[i + 1] |= state[i];
+      }
+    }
+  }
+
+  const program& prog_;
+  cx::array<position, batch_position_capacity> positions_;
+  std::size_t size_;
+  bool valid_;
+};
+
+}  // namespace detail
+
+}  // namespace wildcards
+
+#endif  // WILDCARDS_BATCH_HPP
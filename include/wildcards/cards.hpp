@@ -264,6 +264,124 @@ constexpr cards<T> make_cards(T&& a, T&& s, T&& e, T&& so, T&& sc, T&& sn, T&& a
           std::forward<T>(ao), std::forward<T>(ac), std::forward<T>(ar)};
 }
 
+// Cards known at compile time. Unlike cards, the special items are compared against constants and
+// the branches of disabled sets and alternatives are compiled away.
+template <typename T, T A, T S, T E, T... Extended>
+struct static_cards;
+
+template <typename T, T A, T S, T E>
+struct static_cards<T, A, S, E>
+{
+  static constexpr T anything = A;
+  static constexpr T single = S;
+  static constexpr T escape = E;
+
+  static constexpr bool set_enabled = false;
+  static constexpr T set_open = T();
+  static constexpr T set_close = T();
+  static constexpr T set_not = T();
+
+  static constexpr bool alt_enabled = false;
+  static constexpr T alt_open = T();
+  static constexpr T alt_close = T();
+  static constexpr T alt_or = T();
+};
+
+template <typename T, T A, T S, T E>
+constexpr T static_cards<T, A, S, E>::anything;
+
+template <typename T, T A, T S, T E>
+constexpr T static_cards<T, A, S, E>::single;
+
+template <typename T, T A, T S, T E>
+constexpr T static_cards<T, A, S, E>::escape;
+
+template <typename T, T A, T S, T E>
+constexpr bool static_cards<T, A, S, E>::set_enabled;
+
+template <typename T, T A, T S, T E>
+constexpr T static_cards<T, A, S, E>::set_open;
+
+template <typename T, T A, T S, T E>
+constexpr T static_cards<T, A, S, E>::set_close;
+
+template <typename T, T A, T S, T E>
+constexpr T static_cards<T, A, S, E>::set_not;
+
+template <typename T, T A, T S, T E>
+constexpr bool static_cards<T, A, S, E>::alt_enabled;
+
+template <typename T, T A, T S, T E>
+constexpr T static_cards<T, A, S, E>::alt_open;
+
+template <typename T, T A, T S, T E>
+constexpr T static_cards<T, A, S, E>::alt_close;
+
+template <typename T, T A, T S, T E>
+constexpr T static_cards<T, A, S, E>::alt_or;
+
+template <typename T, T A, T S, T E, T SO, T SC, T SN, T AO, T AC, T AR>
+struct static_cards<T, A, S, E, SO, SC, SN, AO, AC, AR>
+{
+  static constexpr T anything = A;
+  static constexpr T single = S;
+  static constexpr T escape = E;
+
+  static constexpr bool set_enabled = true;
+  static constexpr T set_open = SO;
+  static constexpr T set_close = SC;
+  static constexpr T set_not = SN;
+
+  static constexpr bool alt_enabled = true;
+  static constexpr T alt_open = AO;
+  static constexpr T alt_close = AC;
+  static constexpr T alt_or = AR;
+};
+
+template <typename T, T A, T S, T E, T SO, T SC, T SN, T AO, T AC, T AR>
+constexpr T static_cards<T, A, S, E, SO, SC, SN, AO, AC, AR>::anything;
+
+template <typename T, T A, T S, T E, T SO, T SC, T SN, T AO, T AC, T AR>
+constexpr T static_cards<T, A, S, E, SO, SC, SN, AO, AC, AR>::single;
+
+template <typename T, T A, T S, T E, T SO, T SC, T SN, T AO, T AC, T AR>
+constexpr T static_cards<T, A, S, E, SO, SC, SN, AO, AC, AR>::escape;
+
+template <typename T, T A, T S, T E, T SO, T SC, T SN, T AO, T AC, T AR>
+constexpr bool static_cards<T, A, S, E, SO, SC, SN, AO, AC, AR>::set_enabled;
+
+template <typename T, T A, T S, T E, T SO, T SC, T SN, T AO, T AC, T AR>
+constexpr T static_cards<T, A, S, E, SO, SC, SN, AO, AC, AR>::set_open;
+
+template <typename T, T A, T S, T E, T SO, T SC, T SN, T AO, T AC, T AR>
+constexpr T static_cards<T, A, S, E, SO, SC, SN, AO, AC, AR>::set_close;
+
+template <typename T, T A, T S, T E, T SO, T SC, T SN, T AO, T AC, T AR>
+constexpr T static_cards<T, A, S, E, SO, SC, SN, AO, AC, AR>::set_not;
+
+template <typename T, T A, T S, T E, T SO, T SC, T SN, T AO, T AC, T AR>
+constexpr bool static_cards<T, A, S, E, SO, SC, SN, AO, AC, AR>::alt_enabled;
+
+template <typename T, T A, T S, T E, T SO, T SC, T SN, T AO, T AC, T AR>
+constexpr T static_cards<T, A, S, E, SO, SC, SN, AO, AC, AR>::alt_open;
+
+template <typename T, T A, T S, T E, T SO, T SC, T SN, T AO, T AC, T AR>
+constexpr T static_cards<T, A, S, E, SO, SC, SN, AO, AC, AR>::alt_close;
+
+template <typename T, T A, T S, T E, T SO, T SC, T SN, T AO, T AC, T AR>
+constexpr T static_cards<T, A, S, E, SO, SC, SN, AO, AC, AR>::alt_or;
+
+// The static counterparts of cards<T>(cards_type::standard) and cards<T>(cards_type::extended).
+template <typename T>
+using standard_cards =
+    static_cards<T, static_cast<T>('*'), static_cast<T>('?'), static_cast<T>('\\')>;
+
+template <typename T>
+using extended_cards =
+    static_cards<T, static_cast<T>('*'), static_cast<T>('?'), static_cast<T>('\\'),
+                 static_cast<T>('['), static_cast<T>(']'), static_cast<T>('!'), static_cast<T>('('),
+                 static_cast<T>(')'), static_cast<T>('|')>;
+
 }  // namespace wildcards
 
 #endif  // WILDCARDS_CARDS_HPP
@@ -0,0 +1,335 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef WILDCARDS_DFA_HPP
+#define WILDCARDS_DFA_HPP
+
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t, std::uint8_t
+#include <type_traits>  // std::false_type, std::true_type
+
+#include "config.hpp"             // cfg_constexpr14
+#include "cx/array.hpp"           // cx::array
+#include "wildcards/program.hpp"  // wildcards::detail::bitmap_index, wildcards::detail::opcode,
+                                  // wildcards::detail::program,
+                                  // wildcards::detail::program_capacity,
+                                  // wildcards::detail::set_capacity
+
+namespace wildcards
+{
+
+namespace detail
+{
+
+// The number of the items of a pattern a DFA can follow. The last bit of a state is its end.
+constexpr std::size_t dfa_atom_capacity = 63;
+
+constexpr std::size_t dfa_class_capacity = 64;
+
+constexpr std::size_t dfa_state_capacity = 64;
+
+// The state which matches nothing more and the initial state. A step which needs a new state when
+// there is no room for it returns dfa_state_capacity.
+constexpr std::size_t dfa_dead_state = 0;
+constexpr std::size_t dfa_start_state = 1;
+
+// A DFA whose states are built on demand from a regular program. Each of its states is the set of
+// the items of the pattern (atoms) which can match the next item of the sequence. The items of the
+// sequence are looked up in the classes of the items 0 to 255 which the pattern does not tell apart
+// and the class of all the other items.
+class lazy_dfa
+{
+ public:
+  constexpr lazy_dfa()
+      : follow_{},
+        atoms_{0},
+        class_of_{},
+        accepts_{},
+        classes_{0},
+        states_{},
+        states_size_{0},
+        next_{},
+        valid_{false}
+  {
+  }
+
+  template <typename PatternIterator>
+  cfg_constexpr14 lazy_dfa(const program& prog, PatternIterator p)
+      : follow_{},
+        atoms_{0},
+        class_of_{},
+        accepts_{},
+        classes_{0},
+        states_{},
+        states_size_{0},
+        next_{},
+        valid_{false}
+  {
+    if (!prog.valid() || !prog.regular())
+    {
+      return;
+    }
+
+    cx::array<std::size_t, program_capacity + 1> base{};
+
+    for (std::size_t pc = 0; pc != prog.size(); ++pc)
+    {
+      const auto& in = prog[pc];
+
+      base[pc] = atoms_;
+
+      if (in.op == opcode::literal)
+      {
+        atoms_ += static_cast<std::size_t>(in.last - in.first);
+      }
+      else if (in.op == opcode::single || in.op == opcode::set || in.op == opcode::anything)
+      {
+        ++atoms_;
+      }
+
+      if (atoms_ > dfa_atom_capacity)
+      {
+        return;
+      }
+    }
+
+    for (std::size_t pc = 0; pc != prog.size(); ++pc)
+    {
+      const auto& in = prog[pc];
+
+      if (in.op == opcode::literal)
+      {
+        for (auto i = in.first; i != in.last; ++i)
+        {
+          auto atom = base[pc] + static_cast<std::size_t>(i - in.first);
+
+          follow_[atom] = i + 1 != in.last ? bit(atom + 1) : closure(prog, base, pc + 1);
+        }
+      }
+      else if (in.op == opcode::single || in.op == opcode::set)
+      {
+        follow_[base[pc]] = closure(prog, base, pc + 1);
+      }
+      else if (in.op == opcode::anything)
+      {
+        follow_[base[pc]] = bit(base[pc]) | closure(prog, base, pc + 1);
+      }
+    }
+
+    for (std::size_t index = 0; index <= 256; ++index)
+    {
+      std::uint64_t accepts = 0;
+
+      for (std::size_t pc = 0; pc != prog.size(); ++pc)
+      {
+        const auto& in = prog[pc];
+
+        if (in.op == opcode::literal)
+        {
+          for (auto i = in.first; i != in.last; ++i)
+          {
+            if (bitmap_index(*(p + i)) >= 256)
+            {
+              return;
+            }
+
+            if (bitmap_index(*(p + i)) == index)
+            {
+              accepts |= bit(base[pc] + static_cast<std::size_t>(i - in.first));
+            }
+          }
+        }
+        else if (in.op == opcode::set)
+        {
+          if (in.next == set_capacity)
+          {
+            return;
+          }
+
+          if (prog.bitmap(in.next).contains(index))
+          {
+            accepts |= bit(base[pc]);
+          }
+        }
+        else if (in.op == opcode::single || in.op == opcode::anything)
+        {
+          accepts |= bit(base[pc]);
+        }
+      }
+
+      auto c = std::size_t{0};
+
+      while (c != classes_ && accepts_[c] != accepts)
+      {
+        ++c;
+      }
+
+      if (c == classes_)
+      {
+        if (classes_ == dfa_class_capacity)
+        {
+          return;
+        }
+
+        accepts_[classes_++] = accepts;
+      }
+
+      class_of_[index] = static_cast<std::uint8_t>(c);
+    }
+
+    states_[dfa_dead_state] = 0;
+    states_[dfa_start_state] = closure(prog, base, 0);
+    states_size_ = 2;
+
+    valid_ = true;
+  }
+
+  constexpr bool valid() const
+  {
+    return valid_;
+  }
+
+  constexpr std::size_t size() const
+  {
+    return states_size_;
+  }
+
+  constexpr bool accepting(std::size_t state) const
+  {
+    return (states_[state] & end_bit()) != 0;
+  }
+
+  // Returns the state following the given one on the item of the given bitmap index.
+  cfg_constexpr14 std::size_t next(std::size_t state, std::size_t index)
+  {
+    auto c = class_of_[index < 256 ? index : 256];
+    auto& cached = next_[state * dfa_class_capacity + c];
+
+    if (cached != 0)
+    {
+      return cached - 1u;
+    }
+
+    auto atoms = states_[state] & accepts_[c];
+    std::uint64_t following = 0;
+
+    for (std::size_t atom = 0; atom != atoms_; ++atom)
+    {
+      if ((atoms & bit(atom)) != 0)
+      {
+        following |= follow_[atom];
+      }
+    }
+
+    auto target = std::size_t{0};
+
+    while (target != states_size_ && states_[target] != following)
+    {
+      ++target;
+    }
+
+    if (target == states_size_)
+    {
+      if (states_size_ == dfa_state_capacity)
+      {
+        return dfa_state_capacity;
+      }
+
+      states_[states_size_++] = following;
+    }
+
+    cached = static_cast<std::uint8_t>(target + 1);
+
+    return target;
+  }
+
+ private:
+  static constexpr std::uint64_t bit(std::size_t atom)
+  {
+    return std::uint64_t{1} << atom;
+  }
+
+  static constexpr std::uint64_t end_bit()
+  {
+    return bit(dfa_atom_capacity);
+  }
+
+  // Returns the atoms which can match an item once the program gets to the instruction pc.
+  static cfg_constexpr14 std::uint64_t closure(
+      const program& prog, const cx::array<std::size_t, program_capacity + 1>& base,
+      std::size_t pc)
+  {
+    if (pc == prog.size())
+    {
+      return end_bit();
+    }
+
+    const auto& in = prog[pc];
+
+    switch (in.op)
+    {
+      case opcode::literal:
+      case opcode::single:
+      case opcode::set:
+        return bit(base[pc]);
+
+      case opcode::anything:
+        return bit(base[pc]) | closure(prog, base, pc + 1);
+
+      case opcode::alt_open:
+      {
+        std::uint64_t atoms = 0;
+
+        for (auto sep = pc; sep != in.close; sep = prog[sep].next)
+        {
+          atoms |= closure(prog, base, sep + 1);
+        }
+
+        return atoms;
+      }
+
+      case opcode::alt_or:
+        return closure(prog, base, in.close + 1);
+
+      case opcode::alt_close:
+        return closure(prog, base, pc + 1);
+    }
+
+    return 0;
+  }
+
+  cx::array<std::uint64_t, dfa_atom_capacity> follow_;
+  std::size_t atoms_;
+  cx::array<std::uint8_t, 257> class_of_;
+  cx::array<std::uint64_t, dfa_class_capacity> accepts_;
+  std::size_t classes_;
+  cx::array<std::uint64_t, dfa_state_capacity> states_;
+  std::size_t states_size_;
+
+  // The cached steps indexed by the state and the class, each holding the next state plus one or
+  // zero if the step has not been taken yet.
+  cx::array<std::uint8_t, dfa_state_capacity * dfa_class_capacity> next_;
+
+  bool valid_;
+};
+
+// The DFA can be built only if the items are compared for the equality of their values.
+template <typename PatternIterator>
+cfg_constexpr14 lazy_dfa make_lazy_dfa(const program& prog, PatternIterator p, std::true_type)
+{
+  return lazy_dfa{prog, p};
+}
+
+template <typename PatternIterator>
+constexpr lazy_dfa make_lazy_dfa(const program& /*prog*/, PatternIterator /*p*/, std::false_type)
+{
+  return lazy_dfa{};
+}
+
+}  // namespace detail
+
+}  // namespace wildcards
+
+#endif  // WILDCARDS_DFA_HPP
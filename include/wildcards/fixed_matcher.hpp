@@ -0,0 +1,259 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef WILDCARDS_FIXED_MATCHER_HPP
+#define WILDCARDS_FIXED_MATCHER_HPP
+
+#include "config.hpp"  // cfg_HAS_CLASS_NTTP
+
+#if cfg_HAS_CLASS_NTTP
+
+#include <cstddef>      // std::ptrdiff_t, std::size_t
+#include <cstring>      // std::memcmp
+#include <type_traits>  // std::is_constant_evaluated, std::is_pointer, std::remove_cv,
+                        // std::remove_reference
+
+#include "cx/algorithm.hpp"       // cx::find
+#include "cx/functional.hpp"      // cx::equal_to
+#include "cx/iterator.hpp"        // cx::cbegin, cx::cend
+#include "cx/string_view.hpp"     // cx::make_string_view
+#include "wildcards/cards.hpp"    // wildcards::cards
+#include "wildcards/match.hpp"    // wildcards::full_match_result,
+                                  // wildcards::detail::compares_values,
+                                  // wildcards::detail::compile_program,
+                                  // wildcards::detail::is_nothrow_comparable,
+                                  // wildcards::detail::lowered_begin,
+                                  // wildcards::detail::lowered_end,
+                                  // wildcards::detail::set_mismatch
+#include "wildcards/matcher.hpp"  // wildcards::make_matcher, wildcards::matcher
+#include "wildcards/program.hpp"  // wildcards::detail::opcode, wildcards::detail::program
+#include "wildcards/utility.hpp"  // wildcards::const_iterator_t
+
+namespace wildcards
+{
+
+// A pattern which can be a template argument. It does not include the terminating null.
+template <typename T, std::size_t N>
+struct fixed_pattern
+{
+  constexpr fixed_pattern(const T (&str)[N])
+  {
+    for (std::size_t i = 0; i != N; ++i)
+    {
+      items[i] = str[i];
+    }
+  }
+
+  constexpr const T* begin() const
+  {
+    return items;
+  }
+
+  constexpr const T* end() const
+  {
+    return items + N - 1;
+  }
+
+  T items[N];
+};
+
+// A matcher of the pattern given as a template argument. The program of a pattern without
+// alternatives is expanded into code specialized for it: the part before the first anything and
+// the part after the last one are compared in place, and each part between two anythings is
+// searched for from its leftmost position on, which is where the engine would commit to it. Any
+// other pattern, and any sequence which is not contiguous or holds other items than the pattern, is
+// matched by the engine of a matcher.
+template <fixed_pattern Pattern>
+class fixed_matcher
+{
+  using item_type = typename std::remove_cv<
+      typename std::remove_reference<decltype(Pattern.items[0])>::type>::type;
+
+ public:
+  template <typename Sequence>
+  constexpr bool test(Sequence&& sequence) const
+      noexcept(detail::is_nothrow_comparable<const_iterator_t<Sequence>, const item_type*,
+                                             cx::equal_to<void>>::value)
+  {
+    using sequence_iterator = decltype(detail::lowered_begin(sequence));
+
+    if constexpr (expanded && std::is_pointer<sequence_iterator>::value &&
+                  detail::compares_values<sequence_iterator, const item_type*,
+                                          cx::equal_to<void>>::value)
+    {
+      return run(detail::lowered_begin(sequence), detail::lowered_end(sequence));
+    }
+    else
+    {
+      return engine.test(sequence);
+    }
+  }
+
+  // Matches like matcher::matches(). A mismatch is matched again by the engine, which finds its
+  // positions, so test() is the one to use when the result is only tested.
+  template <typename Sequence>
+  constexpr full_match_result<const_iterator_t<Sequence>, const item_type*> matches(
+      Sequence&& sequence) const
+      noexcept(detail::is_nothrow_comparable<const_iterator_t<Sequence>, const item_type*,
+                                             cx::equal_to<void>>::value)
+  {
+    if (test(sequence))
+    {
+      return {true,          cx::cbegin(sequence), cx::cend(sequence), cx::cend(sequence),
+              Pattern.begin(), Pattern.end(),       Pattern.end()};
+    }
+
+    return engine.matches(sequence);
+  }
+
+ private:
+  static constexpr detail::program prog =
+      detail::compile_program(Pattern.begin(), Pattern.end(), cards<item_type>());
+
+  static constexpr auto engine = make_matcher(cx::make_string_view(
+      Pattern.begin(), static_cast<std::size_t>(Pattern.end() - Pattern.begin())));
+
+  static constexpr bool expanded = prog.valid() && !prog.has_alt();
+
+  // Returns the first anything in [pc, prog.size()) or prog.size() if there is none.
+  static constexpr std::size_t next_star(std::size_t pc)
+  {
+    while (pc != prog.size() && prog[pc].op != detail::opcode::anything)
+    {
+      ++pc;
+    }
+
+    return pc;
+  }
+
+  // Returns the number of the items matched by the instructions in [pc, pc_end), none of which is
+  // an anything.
+  static constexpr std::ptrdiff_t length(std::size_t pc, std::size_t pc_end)
+  {
+    std::ptrdiff_t n = 0;
+
+    for (; pc != pc_end; ++pc)
+    {
+      n += prog[pc].op == detail::opcode::literal ? prog[pc].last - prog[pc].first : 1;
+    }
+
+    return n;
+  }
+
+  // Checks the instructions in [PC, End) against the items from s on, which are known to be there.
+  template <std::size_t PC, std::size_t End, typename SequenceIterator>
+  static constexpr bool run_fixed(SequenceIterator s)
+  {
+    if constexpr (PC == End)
+    {
+      return true;
+    }
+    else
+    {
+      constexpr auto in = prog[PC];
+
+      if constexpr (in.op == detail::opcode::literal)
+      {
+        constexpr auto n = static_cast<std::size_t>(in.last - in.first);
+
+        if (std::is_constant_evaluated())
+        {
+          for (std::size_t i = 0; i != n; ++i)
+          {
+            if (!(s[i] == Pattern.items[static_cast<std::size_t>(in.first) + i]))
+            {
+              return false;
+            }
+          }
+        }
+        else if (std::memcmp(s, Pattern.items + in.first, n * sizeof(item_type)) != 0)
+        {
+          return false;
+        }
+      }
+      else if constexpr (in.op == detail::opcode::set)
+      {
+        if (detail::set_mismatch(prog, in, s, Pattern.begin(), cx::equal_to<void>()) != -1)
+        {
+          return false;
+        }
+      }
+
+      return run_fixed<PC + 1, End>(s + length(PC, PC + 1));
+    }
+  }
+
+  // Matches the sequence from the anything at Star on.
+  template <std::size_t Star, typename SequenceIterator>
+  static constexpr bool run_from(SequenceIterator s, SequenceIterator send)
+  {
+    constexpr auto first = Star + 1;
+    constexpr auto last = next_star(first);
+    constexpr auto n = length(first, last);
+
+    if constexpr (first == last && last == prog.size())
+    {
+      return true;
+    }
+    else if constexpr (last == prog.size())
+    {
+      return send - s >= n && run_fixed<first, last>(send - n);
+    }
+    else
+    {
+      for (; send - s >= n; ++s)
+      {
+        if constexpr (prog[first].op == detail::opcode::literal)
+        {
+          s = cx::find(s, send - n + 1, Pattern.items[prog[first].first]);
+
+          if (send - s < n)
+          {
+            return false;
+          }
+        }
+
+        if (run_fixed<first, last>(s))
+        {
+          return run_from<last>(s + n, send);
+        }
+      }
+
+      return false;
+    }
+  }
+
+  template <typename SequenceIterator>
+  static constexpr bool run(SequenceIterator s, SequenceIterator send)
+  {
+    constexpr auto star = next_star(0);
+    constexpr auto n = length(0, star);
+
+    if (star == prog.size() ? send - s != n : send - s < prog.min_length())
+    {
+      return false;
+    }
+
+    if (!run_fixed<0, star>(s))
+    {
+      return false;
+    }
+
+    if constexpr (star == prog.size())
+    {
+      return true;
+    }
+    else
+    {
+      return run_from<star>(s + n, send);
+    }
+  }
+};
+
+}  // namespace wildcards
+
+#endif  // cfg_HAS_CLASS_NTTP
+
+#endif  // WILDCARDS_FIXED_MATCHER_HPP
@@ -6,16 +6,38 @@
 #ifndef WILDCARDS_MATCH_HPP
 #define WILDCARDS_MATCH_HPP
 
+#include <cstddef>      // std::ptrdiff_t, std::size_t
+#include <cstdint>      // std::uint8_t
+#include <cstdlib>      // std::abort
 #include <stdexcept>    // std::invalid_argument, std::logic_error, std::runtime_error
-#include <type_traits>  // std::enable_if, std::is_same
-#include <utility>      // std::forward, std::move
+#include <type_traits>  // std::enable_if, std::false_type, std::integral_constant, std::is_same,
+                        // std::true_type
+#include <utility>      // std::declval, std::forward, std::move
 
-#include "config.hpp"             // cfg_HAS_CONSTEXPR14, cfg_HAS_FULL_FEATURED_CONSTEXPR14
+#include "config.hpp"             // cfg_HAS_CONSTEXPR14, cfg_HAS_EXCEPTIONS,
+                                  // cfg_HAS_FULL_FEATURED_CONSTEXPR14, cfg_constexpr14
+#include "cx/algorithm.hpp"       // cx::find
 #include "cx/functional.hpp"      // cx::equal_to
-#include "cx/iterator.hpp"        // cx::cbegin, cx::cend, cx::next, cx::prev
-#include "wildcards/cards.hpp"    // wildcards::cards
+#include "cx/iterator.hpp"        // cx::cbegin, cx::cend, cx::data, cx::next, cx::prev, cx::size
+#include "cx/type_traits.hpp"     // cx::is_constant_evaluated
+#include "wildcards/cards.hpp"    // wildcards::cards, wildcards::cards_type,
+                                  // wildcards::extended_cards, wildcards::static_cards
+#include "wildcards/program.hpp"  // wildcards::detail::bitmap_index,
+                                  // wildcards::detail::instruction,
+                                  // wildcards::detail::is_bitmap_item, wildcards::detail::opcode,
+                                  // wildcards::detail::program, wildcards::detail::program_shape,
+                                  // wildcards::detail::program_tables,
+                                  // wildcards::detail::set_bitmap, wildcards::detail::set_capacity,
+                                  // wildcards::detail::set_members_capacity,
+                                  // wildcards::detail::shift_and_capacity,
+                                  // wildcards::detail::shift_and_positions,
+                                  // wildcards::detail::shift_and_state,
+                                  // wildcards::detail::skip_capacity,
+                                  // wildcards::detail::uninitialized_t
+#include "wildcards/simd.hpp"     // wildcards::detail::find_any_byte,
+                                  // wildcards::detail::is_byte_pointer
 #include "wildcards/utility.hpp"  // wildcards::const_iterator_t, wildcards::container_item_t,
-                                  // wildcards::iterated_item_t
+                                  // wildcards::is_contiguous, wildcards::iterated_item_t
 
 namespace wildcards
 {
@@ -33,6 +55,35 @@ struct full_match_result
   }
 };
 
+// Counts how often a compiled matcher checks a sequence up front and how often it rejects the
+// sequence without backtracking.
+struct prefilter_stats
+{
+  std::size_t checks = 0;
+  std::size_t rejections = 0;
+};
+
+// No pattern is an error so far. An escape at the end of a pattern has nothing to escape, and all
+// the engines match it as nothing, so it is not reported either.
+enum class compile_errc
+{
+  none
+};
+
+// The first error found while compiling a pattern and the offset of the item of the pattern it
+// was found at. A pattern which needs more instructions than a program holds is not an error, it is
+// matched without its program.
+struct compile_error
+{
+  compile_errc code;
+  std::ptrdiff_t position;
+
+  constexpr operator bool() const
+  {
+    return code != compile_errc::none;
+  }
+};
+
 namespace detail
 {
 
@@ -68,26 +119,37 @@ constexpr full_match_result<SequenceIterator, PatternIterator> make_full_match_r
 
 #if !cfg_HAS_FULL_FEATURED_CONSTEXPR14
 
+// Without exceptions an error aborts the program, which also keeps it out of constant expressions.
+template <typename Exception, typename T>
+constexpr T throw_exception(T t, const char* what_arg)
+{
+#if cfg_HAS_EXCEPTIONS
+  return what_arg == nullptr ? t : throw Exception(what_arg);
+#else
+  return what_arg == nullptr ? t : (std::abort(), t);
+#endif
+}
+
 constexpr bool throw_invalid_argument(const char* what_arg)
 {
-  return what_arg == nullptr ? false : throw std::invalid_argument(what_arg);
+  return throw_exception<std::invalid_argument>(false, what_arg);
 }
 
 template <typename T>
 constexpr T throw_invalid_argument(T t, const char* what_arg)
 {
-  return what_arg == nullptr ? t : throw std::invalid_argument(what_arg);
+  return throw_exception<std::invalid_argument>(t, what_arg);
 }
 
 constexpr bool throw_logic_error(const char* what_arg)
 {
-  return what_arg == nullptr ? false : throw std::logic_error(what_arg);
+  return throw_exception<std::logic_error>(false, what_arg);
 }
 
 template <typename T>
 constexpr T throw_logic_error(T t, const char* what_arg)
 {
-  return what_arg == nullptr ? t : throw std::logic_error(what_arg);
+  return throw_exception<std::logic_error>(t, what_arg);
 }
 
 #endif
@@ -100,11 +162,9 @@ enum class is_set_state
   next
 };
 
-template <typename PatternIterator>
-constexpr bool is_set(
-    PatternIterator p, PatternIterator pend,
-    const cards<iterated_item_t<PatternIterator>>& c = cards<iterated_item_t<PatternIterator>>(),
-    is_set_state state = is_set_state::open)
+template <typename PatternIterator, typename Cards = cards<iterated_item_t<PatternIterator>>>
+constexpr bool is_set(PatternIterator p, PatternIterator pend, const Cards& c = Cards(),
+                      is_set_state state = is_set_state::open)
 {
 #if cfg_HAS_CONSTEXPR14
 
@@ -180,12 +240,20 @@ constexpr bool is_set(
                         : state == is_set_state::next
                               ? *p == c.set_close ||
                                     is_set(cx::next(p), pend, c, is_set_state::next)
-                              : throw std::logic_error("The program execution should never end up "
-                                                       "here throwing this exception"));
+                              : throw_logic_error("The program execution should never end up "
+                                                  "here throwing this exception"));
 
 #endif  // cfg_HAS_CONSTEXPR14
 }
 
+// The cards are deduced, so a cards_type has to be taken explicitly.
+template <typename PatternIterator>
+constexpr bool is_set(PatternIterator p, PatternIterator pend, cards_type type,
+                      is_set_state state = is_set_state::open)
+{
+  return is_set(p, pend, cards<iterated_item_t<PatternIterator>>(type), state);
+}
+
 enum class set_end_state
 {
   open,
@@ -194,11 +262,9 @@ enum class set_end_state
   next
 };
 
-template <typename PatternIterator>
-constexpr PatternIterator set_end(
-    PatternIterator p, PatternIterator pend,
-    const cards<iterated_item_t<PatternIterator>>& c = cards<iterated_item_t<PatternIterator>>(),
-    set_end_state state = set_end_state::open)
+template <typename PatternIterator, typename Cards = cards<iterated_item_t<PatternIterator>>>
+constexpr PatternIterator set_end(PatternIterator p, PatternIterator pend, const Cards& c = Cards(),
+                                  set_end_state state = set_end_state::open)
 {
 #if cfg_HAS_CONSTEXPR14
 
@@ -274,15 +340,15 @@ constexpr PatternIterator set_end(
 #else  // !cfg_HAS_CONSTEXPR14
 
   return !c.set_enabled
-             ? throw std::invalid_argument("The use of sets is disabled")
+             ? throw_invalid_argument(p, "The use of sets is disabled")
              : p == pend
-                   ? throw std::invalid_argument("The given pattern is not a valid set")
+                   ? throw_invalid_argument(p, "The given pattern is not a valid set")
                    :
 
                    state == set_end_state::open
                        ? *p == c.set_open
                              ? set_end(cx::next(p), pend, c, set_end_state::not_or_first)
-                             : throw std::invalid_argument("The given pattern is not a valid set")
+                             : throw_invalid_argument(p, "The given pattern is not a valid set")
                        :
 
                        state == set_end_state::not_or_first
@@ -294,13 +360,21 @@ constexpr PatternIterator set_end(
                                        ? *p == c.set_close
                                              ? cx::next(p)
                                              : set_end(cx::next(p), pend, c, set_end_state::next)
-                                       : throw std::logic_error(
+                                       : throw_logic_error(
+                                             p,
                                              "The program execution should never end up "
                                              "here throwing this exception");
 
 #endif  // cfg_HAS_CONSTEXPR14
 }
 
+template <typename PatternIterator>
+constexpr PatternIterator set_end(PatternIterator p, PatternIterator pend, cards_type type,
+                                  set_end_state state = set_end_state::open)
+{
+  return set_end(p, pend, cards<iterated_item_t<PatternIterator>>(type), state);
+}
+
 enum class match_set_state
 {
   open,
@@ -311,11 +385,12 @@ enum class match_set_state
 };
 
 template <typename SequenceIterator, typename PatternIterator,
+          typename Cards = cards<iterated_item_t<PatternIterator>>,
           typename EqualTo = cx::equal_to<void>>
 constexpr match_result<SequenceIterator, PatternIterator> match_set(
     SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator pend,
-    const cards<iterated_item_t<PatternIterator>>& c = cards<iterated_item_t<PatternIterator>>(),
-    const EqualTo& equal_to = EqualTo(), match_set_state state = match_set_state::open)
+    const Cards& c = Cards(), const EqualTo& equal_to = EqualTo(),
+    match_set_state state = match_set_state::open)
 {
 #if cfg_HAS_CONSTEXPR14
 
@@ -427,16 +502,18 @@ constexpr match_result<SequenceIterator, PatternIterator> match_set(
 #else  // !cfg_HAS_CONSTEXPR14
 
   return !c.set_enabled
-             ? throw std::invalid_argument("The use of sets is disabled")
+             ? throw_invalid_argument(make_match_result(false, s, p), "The use of sets is disabled")
              : p == pend
-                   ? throw std::invalid_argument("The given pattern is not a valid set")
+                   ? throw_invalid_argument(make_match_result(false, s, p),
+                                            "The given pattern is not a valid set")
                    : state == match_set_state::open
                          ? *p == c.set_open
                                ? match_set(s, send, cx::next(p), pend, c, equal_to,
                                            match_set_state::not_or_first_in)
                                :
 
-                               throw std::invalid_argument("The given pattern is not a valid set")
+                               throw_invalid_argument(make_match_result(false, s, p),
+                                                      "The given pattern is not a valid set")
                          :
 
                          state == match_set_state::not_or_first_in
@@ -478,7 +555,8 @@ constexpr match_result<SequenceIterator, PatternIterator> match_set(
                                                      : match_set(s, send, cx::next(p), pend, c,
                                                                  equal_to, state)
 
-                                         : throw std::logic_error(
+                                         : throw_logic_error(
+                                               make_match_result(false, s, p),
                                                "The program execution should never end up "
                                                "here "
                                                "throwing this exception");
@@ -486,6 +564,17 @@ constexpr match_result<SequenceIterator, PatternIterator> match_set(
 #endif  // cfg_HAS_CONSTEXPR14
 }
 
+template <typename SequenceIterator, typename PatternIterator,
+          typename EqualTo = cx::equal_to<void>>
+constexpr match_result<SequenceIterator, PatternIterator> match_set(
+    SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator pend,
+    cards_type type, const EqualTo& equal_to = EqualTo(),
+    match_set_state state = match_set_state::open)
+{
+  return match_set(s, send, p, pend, cards<iterated_item_t<PatternIterator>>(type), equal_to,
+                   state);
+}
+
 enum class is_alt_state
 {
   open,
@@ -493,11 +582,9 @@ enum class is_alt_state
   escape
 };
 
-template <typename PatternIterator>
-constexpr bool is_alt(
-    PatternIterator p, PatternIterator pend,
-    const cards<iterated_item_t<PatternIterator>>& c = cards<iterated_item_t<PatternIterator>>(),
-    is_alt_state state = is_alt_state::open, int depth = 0)
+template <typename PatternIterator, typename Cards = cards<iterated_item_t<PatternIterator>>>
+constexpr bool is_alt(PatternIterator p, PatternIterator pend, const Cards& c = Cards(),
+                      is_alt_state state = is_alt_state::open, int depth = 0)
 {
 #if cfg_HAS_CONSTEXPR14
 
@@ -556,7 +643,7 @@ constexpr bool is_alt(
             "The program execution should never end up here throwing this exception");
 #else
         return throw_logic_error(
-            p, "The program execution should never end up here throwing this exception");
+            "The program execution should never end up here throwing this exception");
 #endif
     }
 
@@ -587,13 +674,20 @@ constexpr bool is_alt(
 
                     state == is_alt_state::escape
                         ? is_alt(cx::next(p), pend, c, is_alt_state::next, depth)
-                        : throw std::logic_error(
+                        : throw_logic_error(
                               "The program execution should never end up here throwing this "
                               "exception"));
 
 #endif  // cfg_HAS_CONSTEXPR14
 }
 
+template <typename PatternIterator>
+constexpr bool is_alt(PatternIterator p, PatternIterator pend, cards_type type,
+                      is_alt_state state = is_alt_state::open, int depth = 0)
+{
+  return is_alt(p, pend, cards<iterated_item_t<PatternIterator>>(type), state, depth);
+}
+
 enum class alt_end_state
 {
   open,
@@ -601,11 +695,9 @@ enum class alt_end_state
   escape
 };
 
-template <typename PatternIterator>
-constexpr PatternIterator alt_end(
-    PatternIterator p, PatternIterator pend,
-    const cards<iterated_item_t<PatternIterator>>& c = cards<iterated_item_t<PatternIterator>>(),
-    alt_end_state state = alt_end_state::open, int depth = 0)
+template <typename PatternIterator, typename Cards = cards<iterated_item_t<PatternIterator>>>
+constexpr PatternIterator alt_end(PatternIterator p, PatternIterator pend, const Cards& c = Cards(),
+                                  alt_end_state state = alt_end_state::open, int depth = 0)
 {
 #if cfg_HAS_CONSTEXPR14
 
@@ -688,14 +780,14 @@ constexpr PatternIterator alt_end(
 #else  // !cfg_HAS_CONSTEXPR14
 
   return !c.alt_enabled
-             ? throw std::invalid_argument("The use of alternatives is disabled")
+             ? throw_invalid_argument(p, "The use of alternatives is disabled")
              : p == pend
-                   ? throw std::invalid_argument("The given pattern is not a valid alternative")
+                   ? throw_invalid_argument(p, "The given pattern is not a valid alternative")
                    : state == alt_end_state::open
                          ? *p == c.alt_open
                                ? alt_end(cx::next(p), pend, c, alt_end_state::next, depth + 1)
-                               : throw std::invalid_argument(
-                                     "The given pattern is not a valid alternative")
+                               : throw_invalid_argument(
+                                     p, "The given pattern is not a valid alternative")
                          : state == alt_end_state::next
                                ? *p == c.escape
                                      ? alt_end(cx::next(p), pend, c, alt_end_state::escape, depth)
@@ -716,7 +808,8 @@ constexpr PatternIterator alt_end(
 
                                state == alt_end_state::escape
                                    ? alt_end(cx::next(p), pend, c, alt_end_state::next, depth)
-                                   : throw std::logic_error(
+                                   : throw_logic_error(
+                                         p,
                                          "The program execution should never end up here throwing "
                                          "this "
                                          "exception");
@@ -724,16 +817,22 @@ constexpr PatternIterator alt_end(
 #endif  // cfg_HAS_CONSTEXPR14
 }
 
+template <typename PatternIterator>
+constexpr PatternIterator alt_end(PatternIterator p, PatternIterator pend, cards_type type,
+                                  alt_end_state state = alt_end_state::open, int depth = 0)
+{
+  return alt_end(p, pend, cards<iterated_item_t<PatternIterator>>(type), state, depth);
+}
+
 enum class alt_sub_end_state
 {
   next,
   escape
 };
 
-template <typename PatternIterator>
+template <typename PatternIterator, typename Cards = cards<iterated_item_t<PatternIterator>>>
 constexpr PatternIterator alt_sub_end(
-    PatternIterator p, PatternIterator pend,
-    const cards<iterated_item_t<PatternIterator>>& c = cards<iterated_item_t<PatternIterator>>(),
+    PatternIterator p, PatternIterator pend, const Cards& c = Cards(),
     alt_sub_end_state state = alt_sub_end_state::next, int depth = 1)
 {
 #if cfg_HAS_CONSTEXPR14
@@ -810,9 +909,9 @@ constexpr PatternIterator alt_sub_end(
 #else  // !cfg_HAS_CONSTEXPR14
 
   return !c.alt_enabled
-             ? throw std::invalid_argument("The use of alternatives is disabled")
+             ? throw_invalid_argument(p, "The use of alternatives is disabled")
              : p == pend
-                   ? throw std::invalid_argument("The given pattern is not a valid alternative")
+                   ? throw_invalid_argument(p, "The given pattern is not a valid alternative")
                    : state == alt_sub_end_state::next
                          ? *p == c.escape
                                ? alt_sub_end(cx::next(p), pend, c, alt_sub_end_state::escape, depth)
@@ -836,7 +935,8 @@ constexpr PatternIterator alt_sub_end(
 
                          state == alt_sub_end_state::escape
                              ? alt_sub_end(cx::next(p), pend, c, alt_sub_end_state::next, depth)
-                             : throw std::logic_error(
+                             : throw_logic_error(
+                                   p,
                                    "The program execution should never end up here throwing "
                                    "this "
                                    "exception");
@@ -845,19 +945,205 @@ constexpr PatternIterator alt_sub_end(
 }
 
 template <typename SequenceIterator, typename PatternIterator,
+          typename Cards = cards<iterated_item_t<PatternIterator>>,
           typename EqualTo = cx::equal_to<void>>
 constexpr match_result<SequenceIterator, PatternIterator> match(
     SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator pend,
-    const cards<iterated_item_t<PatternIterator>>& c = cards<iterated_item_t<PatternIterator>>(),
-    const EqualTo& equal_to = EqualTo(), bool partial = false, bool escape = false);
+    const Cards& c = Cards(), const EqualTo& equal_to = EqualTo(), bool partial = false,
+    bool escape = false);
 
 template <typename SequenceIterator, typename PatternIterator,
+          typename Cards = cards<iterated_item_t<PatternIterator>>,
           typename EqualTo = cx::equal_to<void>>
 constexpr match_result<SequenceIterator, PatternIterator> match_alt(
     SequenceIterator s, SequenceIterator send, PatternIterator p1, PatternIterator p1end,
-    PatternIterator p2, PatternIterator p2end,
-    const cards<iterated_item_t<PatternIterator>>& c = cards<iterated_item_t<PatternIterator>>(),
-    const EqualTo& equal_to = EqualTo(), bool partial = false)
+    PatternIterator p2, PatternIterator p2end, const Cards& c = Cards(),
+    const EqualTo& equal_to = EqualTo(), bool partial = false);
+
+#if !cfg_HAS_CONSTEXPR14
+
+// The C++11 implementation cannot store intermediate results in variables, so the following
+// helpers receive an already computed sub-match as a parameter. That way each sub-match is
+// evaluated only once instead of once per its appearance in a conditional expression.
+
+// The recursion of the C++11 implementation is as deep as the evaluation is long, so the helpers
+// below halve the ranges they go through instead of stepping over them one item at a time. That
+// keeps the depth logarithmic in the length of the sequence and of the runs of literals.
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> match_rest_in(
+    SequenceIterator s, std::ptrdiff_t n, SequenceIterator send, PatternIterator p,
+    PatternIterator pend, const Cards& c, const EqualTo& equal_to, bool partial);
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> match_rest_right(
+    SequenceIterator s, std::ptrdiff_t n, SequenceIterator send, PatternIterator p,
+    PatternIterator pend, const Cards& c, const EqualTo& equal_to, bool partial,
+    const match_result<SequenceIterator, PatternIterator>& left)
+{
+  return left ? left
+              : match_rest_in(s + n / 2, n - n / 2, send, p, pend, c, equal_to, partial);
+}
+
+// Matches [p, pend) from the leftmost of the n positions from s on it matches at.
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> match_rest_in(
+    SequenceIterator s, std::ptrdiff_t n, SequenceIterator send, PatternIterator p,
+    PatternIterator pend, const Cards& c, const EqualTo& equal_to, bool partial)
+{
+  return n == 1 ? match(s, send, p, pend, c, equal_to, partial)
+                : match_rest_right(s, n, send, p, pend, c, equal_to, partial,
+                                   match_rest_in(s, n / 2, send, p, pend, c, equal_to, partial));
+}
+
+template <typename SequenceIterator, typename PatternIterator>
+constexpr match_result<SequenceIterator, PatternIterator> match_anything_result(
+    SequenceIterator send, PatternIterator p,
+    const match_result<SequenceIterator, PatternIterator>& rest)
+{
+  return rest ? rest : make_match_result(false, send, p);
+}
+
+// Matches the anything at p. An anything which ends the pattern takes the rest of the sequence
+// right away, any other one tries the positions up to the end of the sequence in halves.
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> match_anything(
+    SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator pend,
+    const Cards& c, const EqualTo& equal_to, bool partial)
+{
+  return cx::next(p) == pend
+             ? make_match_result(true, partial ? s : send, pend)
+             : match_anything_result(send, p,
+                                     match_rest_in(s, send - s + 1, send, cx::next(p), pend, c,
+                                                   equal_to, partial));
+}
+
+// Returns whether the item ends a run of literals, which is where it is not matched as a literal.
+template <typename T, typename Cards>
+constexpr bool ends_literals(const T& item, const Cards& c)
+{
+  return item == c.anything || item == c.single || item == c.escape ||
+         (c.set_enabled && item == c.set_open) || (c.alt_enabled && item == c.alt_open);
+}
+
+template <typename PatternIterator, typename Cards>
+constexpr PatternIterator literals_end(PatternIterator p, PatternIterator pend, const Cards& c);
+
+template <typename PatternIterator, typename Cards>
+constexpr PatternIterator literals_end_right(PatternIterator middle, PatternIterator pend,
+                                             const Cards& c, PatternIterator left)
+{
+  return left != middle ? left : literals_end(middle, pend, c);
+}
+
+// Returns the first item in [p, pend) which ends a run of literals or pend if there is none.
+template <typename PatternIterator, typename Cards>
+constexpr PatternIterator literals_end(PatternIterator p, PatternIterator pend, const Cards& c)
+{
+  return pend - p <= 1 ? p == pend || ends_literals(*p, c) ? p : pend
+                       : literals_end_right(p + (pend - p) / 2, pend, c,
+                                            literals_end(p, p + (pend - p) / 2, c));
+}
+
+template <typename SequenceIterator, typename PatternIterator, typename EqualTo>
+constexpr std::ptrdiff_t count_equal(SequenceIterator s, PatternIterator p, std::ptrdiff_t n,
+                                     const EqualTo& equal_to);
+
+template <typename SequenceIterator, typename PatternIterator, typename EqualTo>
+constexpr std::ptrdiff_t count_equal_right(SequenceIterator s, PatternIterator p, std::ptrdiff_t n,
+                                           const EqualTo& equal_to, std::ptrdiff_t left)
+{
+  return left != n / 2 ? left
+                       : n / 2 + count_equal(s + n / 2, p + n / 2, n - n / 2, equal_to);
+}
+
+// Returns the number of the leading items of the n items from s on equal to those from p on.
+template <typename SequenceIterator, typename PatternIterator, typename EqualTo>
+constexpr std::ptrdiff_t count_equal(SequenceIterator s, PatternIterator p, std::ptrdiff_t n,
+                                     const EqualTo& equal_to)
+{
+  return n <= 1 ? n == 1 && equal_to(*s, *p) ? 1 : 0
+                : count_equal_right(s, p, n, equal_to, count_equal(s, p, n / 2, equal_to));
+}
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> match_after_literals(
+    SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator p_run_end,
+    PatternIterator pend, const Cards& c, const EqualTo& equal_to, bool partial,
+    std::ptrdiff_t equal)
+{
+  return equal != p_run_end - p ? make_match_result(false, s + equal, p + equal)
+                                : match(s + equal, send, p_run_end, pend, c, equal_to, partial);
+}
+
+// Matches the run of literals [p, p_run_end) at once and then the rest of the pattern.
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> match_literals(
+    SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator p_run_end,
+    PatternIterator pend, const Cards& c, const EqualTo& equal_to, bool partial)
+{
+  return match_after_literals(
+      s, send, p, p_run_end, pend, c, equal_to, partial,
+      count_equal(s, p, p_run_end - p < send - s ? p_run_end - p : send - s, equal_to));
+}
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> match_after_set(
+    SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator pend,
+    const Cards& c, const EqualTo& equal_to, bool partial,
+    const match_result<SequenceIterator, PatternIterator>& set)
+{
+  return !set ? set
+              : match(cx::next(s), send,
+                      set_end(cx::next(p), pend, c, set_end_state::not_or_first), pend, c,
+                      equal_to, partial);
+}
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> match_alt_from(
+    SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator p_alt_end,
+    PatternIterator pend, const Cards& c, const EqualTo& equal_to, bool partial)
+{
+  return match_alt(s, send, cx::next(p), alt_sub_end(cx::next(p), p_alt_end, c), p_alt_end, pend,
+                   c, equal_to, partial);
+}
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> match_alt_next(
+    SequenceIterator s, SequenceIterator send, PatternIterator p1end, PatternIterator p2,
+    PatternIterator p2end, const Cards& c, const EqualTo& equal_to, bool partial)
+{
+  return cx::next(p1end) == p2 ? make_match_result(false, s, p1end)
+                               : match_alt_from(s, send, p1end, p2, p2end, c, equal_to, partial);
+}
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> match_alt_rest(
+    SequenceIterator s, SequenceIterator send, PatternIterator p1end, PatternIterator p2,
+    PatternIterator p2end, const Cards& c, const EqualTo& equal_to, bool partial,
+    const match_result<SequenceIterator, PatternIterator>& result2)
+{
+  return result2 ? result2 : match_alt_next(s, send, p1end, p2, p2end, c, equal_to, partial);
+}
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> match_alt_sub(
+    SequenceIterator s, SequenceIterator send, PatternIterator p1end, PatternIterator p2,
+    PatternIterator p2end, const Cards& c, const EqualTo& equal_to, bool partial,
+    const match_result<SequenceIterator, PatternIterator>& result1)
+{
+  return result1 ? match_alt_rest(s, send, p1end, p2, p2end, c, equal_to, partial,
+                                  match(result1.s, send, p2, p2end, c, equal_to, partial))
+                 : match_alt_next(s, send, p1end, p2, p2end, c, equal_to, partial);
+}
+
+#endif  // !cfg_HAS_CONSTEXPR14
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> match_alt(
+    SequenceIterator s, SequenceIterator send, PatternIterator p1, PatternIterator p1end,
+    PatternIterator p2, PatternIterator p2end, const Cards& c, const EqualTo& equal_to,
+    bool partial)
 {
 #if cfg_HAS_CONSTEXPR14
 
@@ -884,103 +1170,238 @@ constexpr match_result<SequenceIterator, PatternIterator> match_alt(
 
 #else  // !cfg_HAS_CONSTEXPR14
 
-  return match(s, send, p1, p1end, c, equal_to, true) &&
-                 match(match(s, send, p1, p1end, c, equal_to, true).s, send, p2, p2end, c, equal_to,
-                       partial)
-             ? match(match(s, send, p1, p1end, c, equal_to, true).s, send, p2, p2end, c, equal_to,
-                     partial)
-             : cx::next(p1end) == p2
-                   ? make_match_result(false, s, p1end)
-                   : match_alt(s, send, cx::next(p1end), alt_sub_end(cx::next(p1end), p2, c), p2,
-                               p2end, c, equal_to, partial);
+  return match_alt_sub(s, send, p1end, p2, p2end, c, equal_to, partial,
+                       match(s, send, p1, p1end, c, equal_to, true));
 
 #endif  // cfg_HAS_CONSTEXPR14
 }
 
-template <typename SequenceIterator, typename PatternIterator, typename EqualTo>
+#if cfg_HAS_CONSTEXPR14
+
+enum class match_frame_kind
+{
+  anything,
+  alt_sub,
+  alt_rest
+};
+
+// A pending anything or alternative of the iterative wildcards::detail::match().
+template <typename SequenceIterator, typename PatternIterator>
+struct match_frame
+{
+  match_frame_kind kind;
+
+  // The position in the sequence where the anything or the alternative started to match.
+  SequenceIterator s;
+
+  // The anything, or the end of the currently tried sub-pattern and the end of the alternative.
+  PatternIterator p;
+  PatternIterator p_alt_end;
+
+  // The end of the pattern and the partial flag the anything or the alternative was matched with.
+  PatternIterator pend;
+  bool partial;
+};
+
+constexpr std::size_t match_stack_capacity = 16;
+
+#endif  // cfg_HAS_CONSTEXPR14
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
 constexpr match_result<SequenceIterator, PatternIterator> match(
     SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator pend,
-    const cards<iterated_item_t<PatternIterator>>& c, const EqualTo& equal_to, bool partial,
-    bool escape)
+    const Cards& c, const EqualTo& equal_to, bool partial, bool escape)
 {
 #if cfg_HAS_CONSTEXPR14
 
-  if (p == pend)
-  {
-    return make_match_result(partial || s == send, s, p);
-  }
+  // The literals, singles and sets are matched in a loop. Anythings and alternatives are the only
+  // backtracking points and are kept in an explicit stack, so the depth depends on the pattern
+  // only. Should the stack get full, the pending anything or alternative is matched by a nested
+  // call which has a stack of its own.
 
-  if (escape)
-  {
-    if (s == send || !equal_to(*s, *p))
-    {
-      return make_match_result(false, s, p);
-    }
+  match_frame<SequenceIterator, PatternIterator> stack[match_stack_capacity]{};
+  std::size_t depth = 0;
 
-    return match(cx::next(s), send, cx::next(p), pend, c, equal_to, partial);
-  }
+  auto result = make_match_result(false, s, p);
+  auto returning = false;
 
-  if (*p == c.anything)
+  while (true)
   {
-    auto result = match(s, send, cx::next(p), pend, c, equal_to, partial);
-
-    if (result)
+    if (!returning)
     {
-      return result;
+      if (p == pend)
+      {
+        result = make_match_result(partial || s == send, s, p);
+        returning = true;
+      }
+      else if (escape)
+      {
+        if (s == send || !equal_to(*s, *p))
+        {
+          result = make_match_result(false, s, p);
+          returning = true;
+        }
+        else
+        {
+          s = cx::next(s);
+          p = cx::next(p);
+          escape = false;
+        }
+      }
+      else if (*p == c.anything)
+      {
+        if (depth == match_stack_capacity)
+        {
+          result = match(s, send, p, pend, c, equal_to, partial);
+          returning = true;
+        }
+        else
+        {
+          stack[depth++] = {match_frame_kind::anything, s, p, p, pend, partial};
+          p = cx::next(p);
+        }
+      }
+      else if (*p == c.single)
+      {
+        if (s == send)
+        {
+          result = make_match_result(false, s, p);
+          returning = true;
+        }
+        else
+        {
+          s = cx::next(s);
+          p = cx::next(p);
+        }
+      }
+      else if (*p == c.escape)
+      {
+        p = cx::next(p);
+        escape = true;
+      }
+      else if (c.set_enabled && *p == c.set_open &&
+               is_set(cx::next(p), pend, c, is_set_state::not_or_first))
+      {
+        result =
+            match_set(s, send, cx::next(p), pend, c, equal_to, match_set_state::not_or_first_in);
+
+        if (!result)
+        {
+          returning = true;
+        }
+        else
+        {
+          s = cx::next(s);
+          p = set_end(cx::next(p), pend, c, set_end_state::not_or_first);
+        }
+      }
+      else if (c.alt_enabled && *p == c.alt_open &&
+               is_alt(cx::next(p), pend, c, is_alt_state::next, 1))
+      {
+        if (depth == match_stack_capacity)
+        {
+          result = match(s, send, p, pend, c, equal_to, partial);
+          returning = true;
+        }
+        else
+        {
+          auto p_alt_end = alt_end(cx::next(p), pend, c, alt_end_state::next, 1);
+          auto p_sub_end = alt_sub_end(cx::next(p), p_alt_end, c);
+
+          stack[depth++] = {match_frame_kind::alt_sub, s, p_sub_end, p_alt_end, pend, partial};
+
+          p = cx::next(p);
+          pend = p_sub_end;
+          partial = true;
+        }
+      }
+      else if (s == send || !equal_to(*s, *p))
+      {
+        result = make_match_result(false, s, p);
+        returning = true;
+      }
+      else
+      {
+        s = cx::next(s);
+        p = cx::next(p);
+      }
+
+      continue;
     }
 
-    if (s == send)
+    if (depth == 0)
     {
-      return make_match_result(false, s, p);
+      return result;
     }
 
-    return match(cx::next(s), send, p, pend, c, equal_to, partial);
-  }
+    auto& frame = stack[depth - 1];
 
-  if (*p == c.single)
-  {
-    if (s == send)
+    if (frame.kind == match_frame_kind::anything)
     {
-      return make_match_result(false, s, p);
+      if (result)
+      {
+        --depth;
+      }
+      else if (frame.s == send)
+      {
+        result = make_match_result(false, frame.s, frame.p);
+        --depth;
+      }
+      else
+      {
+        frame.s = cx::next(frame.s);
+
+        s = frame.s;
+        p = cx::next(frame.p);
+        pend = frame.pend;
+        partial = frame.partial;
+        escape = false;
+        returning = false;
+      }
+
+      continue;
     }
 
-    return match(cx::next(s), send, cx::next(p), pend, c, equal_to, partial);
-  }
+    if (frame.kind == match_frame_kind::alt_sub && result)
+    {
+      frame.kind = match_frame_kind::alt_rest;
 
-  if (*p == c.escape)
-  {
-    return match(s, send, cx::next(p), pend, c, equal_to, partial, true);
-  }
+      s = result.s;
+      p = frame.p_alt_end;
+      pend = frame.pend;
+      partial = frame.partial;
+      escape = false;
+      returning = false;
 
-  if (c.set_enabled && *p == c.set_open && is_set(cx::next(p), pend, c, is_set_state::not_or_first))
-  {
-    auto result =
-        match_set(s, send, cx::next(p), pend, c, equal_to, match_set_state::not_or_first_in);
+      continue;
+    }
 
-    if (!result)
+    if (frame.kind == match_frame_kind::alt_rest && result)
     {
-      return result;
+      --depth;
+      continue;
     }
 
-    return match(cx::next(s), send, set_end(cx::next(p), pend, c, set_end_state::not_or_first),
-                 pend, c, equal_to, partial);
-  }
+    // The current sub-pattern of the alternative failed, so let's try the next one.
 
-  if (c.alt_enabled && *p == c.alt_open && is_alt(cx::next(p), pend, c, is_alt_state::next, 1))
-  {
-    auto p_alt_end = alt_end(cx::next(p), pend, c, alt_end_state::next, 1);
+    if (cx::next(frame.p) == frame.p_alt_end)
+    {
+      result = make_match_result(false, frame.s, frame.p);
+      --depth;
+      continue;
+    }
 
-    return match_alt(s, send, cx::next(p), alt_sub_end(cx::next(p), p_alt_end, c), p_alt_end, pend,
-                     c, equal_to, partial);
-  }
+    frame.kind = match_frame_kind::alt_sub;
 
-  if (s == send || !equal_to(*s, *p))
-  {
-    return make_match_result(false, s, p);
+    s = frame.s;
+    p = cx::next(frame.p);
+    frame.p = alt_sub_end(p, frame.p_alt_end, c);
+    pend = frame.p;
+    partial = true;
+    escape = false;
+    returning = false;
   }
 
-  return match(cx::next(s), send, cx::next(p), pend, c, equal_to, partial);
-
 #else  // !cfg_HAS_CONSTEXPR14
 
   return p == pend
@@ -990,10 +1411,7 @@ constexpr match_result<SequenceIterator, PatternIterator> match(
                          ? make_match_result(false, s, p)
                          : match(cx::next(s), send, cx::next(p), pend, c, equal_to, partial)
                    : *p == c.anything
-                         ? match(s, send, cx::next(p), pend, c, equal_to, partial)
-                               ? match(s, send, cx::next(p), pend, c, equal_to, partial)
-                               : s == send ? make_match_result(false, s, p)
-                                           : match(cx::next(s), send, p, pend, c, equal_to, partial)
+                         ? match_anything(s, send, p, pend, c, equal_to, partial)
                          : *p == c.single
                                ? s == send ? make_match_result(false, s, p)
                                            : match(cx::next(s), send, cx::next(p), pend, c,
@@ -1003,56 +1421,1642 @@ constexpr match_result<SequenceIterator, PatternIterator> match(
                                      : c.set_enabled && *p == c.set_open &&
                                                is_set(cx::next(p), pend, c,
                                                       is_set_state::not_or_first)
-                                           ? !match_set(s, send, cx::next(p), pend, c, equal_to,
-                                                        match_set_state::not_or_first_in)
-                                                 ? match_set(s, send, cx::next(p), pend, c,
-                                                             equal_to,
-                                                             match_set_state::not_or_first_in)
-                                                 : match(cx::next(s), send,
-                                                         set_end(cx::next(p), pend, c,
-                                                                 set_end_state::not_or_first),
-                                                         pend, c, equal_to, partial)
+                                           ? match_after_set(
+                                                 s, send, p, pend, c, equal_to, partial,
+                                                 match_set(s, send, cx::next(p), pend, c, equal_to,
+                                                           match_set_state::not_or_first_in))
                                            : c.alt_enabled && *p == c.alt_open &&
                                                      is_alt(cx::next(p), pend, c,
                                                             is_alt_state::next, 1)
-                                                 ? match_alt(
-                                                       s, send, cx::next(p),
-                                                       alt_sub_end(cx::next(p),
-                                                                   alt_end(cx::next(p), pend, c,
-                                                                           alt_end_state::next, 1),
-                                                                   c),
-                                                       alt_end(cx::next(p), pend, c,
-                                                               alt_end_state::next, 1),
-                                                       pend, c, equal_to, partial)
-                                                 : s == send || !equal_to(*s, *p)
-                                                       ? make_match_result(false, s, p)
-                                                       : match(cx::next(s), send, cx::next(p), pend,
-                                                               c, equal_to, partial);
+                                                 ? match_alt_from(s, send, p,
+                                                                  alt_end(cx::next(p), pend, c,
+                                                                          alt_end_state::next, 1),
+                                                                  pend, c, equal_to, partial)
+                                                 : match_literals(
+                                                       s, send, p,
+                                                       literals_end(cx::next(p), pend, c), pend,
+                                                       c, equal_to, partial);
 
 #endif  // cfg_HAS_CONSTEXPR14
 }
 
-}  // namespace detail
+// Returns whether the pattern has an opening card of an alternative, which is found without
+// parsing it. A pattern lacking the card has no alternative.
+template <typename PatternIterator, typename Cards>
+cfg_constexpr14 bool has_alt_open(PatternIterator p, PatternIterator pend, const Cards& c)
+{
+  return c.alt_enabled && cx::find(p, pend, c.alt_open) != pend;
+}
 
-template <typename Sequence, typename Pattern, typename EqualTo = cx::equal_to<void>>
+template <typename PatternIterator, typename Cards = cards<iterated_item_t<PatternIterator>>>
+cfg_constexpr14 bool has_alt(PatternIterator p, PatternIterator pend, const Cards& c = Cards())
+{
+  if (!has_alt_open(p, pend, c))
+  {
+    return false;
+  }
+
+  while (p != pend)
+  {
+    if (*p == c.escape)
+    {
+      p = cx::next(p);
+
+      if (p == pend)
+      {
+        break;
+      }
+    }
+    else if (c.set_enabled && *p == c.set_open &&
+             is_set(cx::next(p), pend, c, is_set_state::not_or_first))
+    {
+      p = cx::prev(set_end(cx::next(p), pend, c, set_end_state::not_or_first));
+    }
+    else if (*p == c.alt_open && is_alt(cx::next(p), pend, c, is_alt_state::next, 1))
+    {
+      return true;
+    }
+
+    p = cx::next(p);
+  }
+
+  return false;
+}
+
+template <typename PatternIterator>
+cfg_constexpr14 bool has_alt(PatternIterator p, PatternIterator pend, cards_type type)
+{
+  return has_alt(p, pend, cards<iterated_item_t<PatternIterator>>(type));
+}
+
+// Matches a pattern without alternatives. Since all the other cards but anything match exactly one
+// item, only the position of the last anything seen needs to be remembered for backtracking, which
+// makes the worst case O(n * m) instead of exponential.
+template <typename SequenceIterator, typename PatternIterator,
+          typename Cards = cards<iterated_item_t<PatternIterator>>,
+          typename EqualTo = cx::equal_to<void>>
+cfg_constexpr14 match_result<SequenceIterator, PatternIterator> match_flat(
+    SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator pend,
+    const Cards& c = Cards(), const EqualTo& equal_to = EqualTo())
+{
+  auto star = false;
+  auto first_star_p = p;
+  auto star_s = s;
+  auto star_p = p;
+
+  while (true)
+  {
+    // Where the sequence fails to match, kept apart from the result so that the result is made only
+    // once it is returned.
+    auto fail_s = s;
+    auto fail_p = p;
+
+    if (p == pend)
+    {
+      if (s == send)
+      {
+        return make_match_result(true, s, p);
+      }
+    }
+    else if (*p == c.anything)
+    {
+      if (!star)
+      {
+        star = true;
+        first_star_p = p;
+      }
+
+      star_s = s;
+      star_p = p;
+      p = cx::next(p);
+      continue;
+    }
+    else if (*p == c.single)
+    {
+      if (s != send)
+      {
+        s = cx::next(s);
+        p = cx::next(p);
+        continue;
+      }
+    }
+    else if (*p == c.escape)
+    {
+      p = cx::next(p);
+
+      if (p == pend)
+      {
+        continue;
+      }
+
+      if (s != send && equal_to(*s, *p))
+      {
+        s = cx::next(s);
+        p = cx::next(p);
+        continue;
+      }
+
+      fail_p = p;
+    }
+    else if (c.set_enabled && *p == c.set_open &&
+             is_set(cx::next(p), pend, c, is_set_state::not_or_first))
+    {
+      auto set_result =
+          match_set(s, send, cx::next(p), pend, c, equal_to, match_set_state::not_or_first_in);
+
+      if (set_result)
+      {
+        s = cx::next(s);
+        p = set_end(cx::next(p), pend, c, set_end_state::not_or_first);
+        continue;
+      }
+
+      fail_s = set_result.s;
+      fail_p = set_result.p;
+    }
+    else if (s != send && equal_to(*s, *p))
+    {
+      s = cx::next(s);
+      p = cx::next(p);
+      continue;
+    }
+
+    if (!star)
+    {
+      return make_match_result(false, fail_s, fail_p);
+    }
+
+    if (star_s == send)
+    {
+      return make_match_result(false, star_s, first_star_p);
+    }
+
+    star_s = cx::next(star_s);
+    s = star_s;
+    p = cx::next(star_p);
+  }
+}
+
+template <typename PatternIterator>
+cfg_constexpr14 std::size_t compile_set(program& prog, PatternIterator first, PatternIterator last,
+                                        bool negated, std::true_type)
+{
+  set_bitmap bitmap{};
+
+  for (auto p = first; p != last; p = cx::next(p))
+  {
+    if (bitmap_index(*p) >= 256)
+    {
+      return set_capacity;
+    }
+
+    bitmap.insert(bitmap_index(*p));
+  }
+
+  if (negated)
+  {
+    bitmap.negate();
+  }
+
+  return prog.push_bitmap(bitmap);
+}
+
+template <typename PatternIterator>
+cfg_constexpr14 std::size_t compile_set(program& /*prog*/, PatternIterator /*first*/,
+                                        PatternIterator /*last*/, bool /*negated*/,
+                                        std::false_type)
+{
+  return set_capacity;
+}
+
+template <typename T, typename Cards>
+constexpr bool is_card(const T& item, const Cards& c)
+{
+  return item == c.anything || item == c.single || item == c.escape ||
+         (c.set_enabled && item == c.set_open) ||
+         (c.alt_enabled && (item == c.alt_open || item == c.alt_or || item == c.alt_close));
+}
+
+// Returns the opening of the innermost alternative which the program has not closed yet.
+inline cfg_constexpr14 std::size_t open_alt(const program& prog)
+{
+  auto pc = prog.size() - 1;
+
+  while (prog[pc].op != opcode::alt_open || prog[pc].close != 0)
+  {
+    --pc;
+  }
+
+  return pc;
+}
+
+// Compiles the pattern in a single pass unless lookahead is set. The pass takes an opening card
+// for an alternative right away and resolves it by the closing card which matches it, while the
+// separators in between belong to the innermost alternative left open. This holds only if every
+// opening card has a closing one, so the pass returns false if an alternative is left open (or
+// cannot be pushed), and the pattern is then compiled again with lookahead. That looks ahead for
+// the closing card at each opening one and compiles the ways of an alternative one by one.
+template <typename PatternIterator, typename Cards>
+cfg_constexpr14 bool compile_sequence(program& prog, PatternIterator pbegin, PatternIterator p,
+                                      PatternIterator pend, const Cards& c, bool lookahead)
+{
+  std::size_t open = 0;
+
+  while (p != pend)
+  {
+    if (*p == c.anything || *p == c.single)
+    {
+      // A run of anythings and singles matches at least as many items as it has singles, so it
+      // is compiled into the singles followed by a single anything. The singles which come after
+      // the first anything fail only where the anything would, so they take over its position.
+      auto star = pend;
+
+      while (p != pend && (*p == c.anything || *p == c.single))
+      {
+        if (*p == c.single)
+        {
+          prog.push(instruction{opcode::single, (star == pend ? p : star) - pbegin});
+        }
+        else if (star == pend)
+        {
+          star = p;
+        }
+
+        p = cx::next(p);
+      }
+
+      if (star != pend)
+      {
+        prog.push(instruction{opcode::anything, star - pbegin});
+      }
+    }
+    else if (*p == c.escape)
+    {
+      p = cx::next(p);
+
+      if (p != pend)
+      {
+        prog.push_literal(p - pbegin, p - pbegin + 1);
+        p = cx::next(p);
+      }
+    }
+    else if (c.set_enabled && *p == c.set_open &&
+             is_set(cx::next(p), pend, c, is_set_state::not_or_first))
+    {
+      auto first = cx::next(p);
+      auto negated = *first == c.set_not;
+
+      if (negated)
+      {
+        first = cx::next(first);
+      }
+
+      auto last = cx::prev(set_end(cx::next(p), pend, c, set_end_state::not_or_first));
+
+      auto pc = prog.push(instruction{opcode::set, first - pbegin, last - pbegin, negated});
+
+      if (pc != prog.size())
+      {
+        prog[pc].next = compile_set(prog, first, last, negated,
+                                    is_bitmap_item<iterated_item_t<PatternIterator>>());
+      }
+
+      p = cx::next(last);
+    }
+    else if (c.alt_enabled && *p == c.alt_open && !lookahead)
+    {
+      if (prog.push(instruction{opcode::alt_open, p - pbegin}) == prog.size())
+      {
+        return false;
+      }
+
+      ++open;
+      p = cx::next(p);
+    }
+    else if (open != 0 && (*p == c.alt_or || *p == c.alt_close))
+    {
+      auto pc_open = open_alt(prog);
+      auto pc_sep = pc_open;
+
+      while (prog[pc_sep].next != 0)
+      {
+        pc_sep = prog[pc_sep].next;
+      }
+
+      auto closing = *p == c.alt_close;
+      auto pc = prog.push(instruction{closing ? opcode::alt_close : opcode::alt_or, p - pbegin});
+
+      if (pc == prog.size())
+      {
+        return false;
+      }
+
+      prog[pc_sep].next = pc;
+
+      if (closing)
+      {
+        for (auto i = pc_open; i != pc; i = prog[i].next)
+        {
+          prog[i].close = pc;
+        }
+
+        --open;
+      }
+
+      p = cx::next(p);
+    }
+    else if (c.alt_enabled && *p == c.alt_open &&
+             is_alt(cx::next(p), pend, c, is_alt_state::next, 1))
+    {
+      auto p_alt_end = alt_end(cx::next(p), pend, c, alt_end_state::next, 1);
+      auto pc_open = prog.push(instruction{opcode::alt_open, p - pbegin});
+      auto pc_sep = pc_open;
+      auto p_sub = cx::next(p);
+
+      while (true)
+      {
+        auto p_sub_end = alt_sub_end(p_sub, p_alt_end, c);
+
+        compile_sequence(prog, pbegin, p_sub, p_sub_end, c, true);
+
+        auto closing = cx::next(p_sub_end) == p_alt_end;
+        auto pc = prog.push(
+            instruction{closing ? opcode::alt_close : opcode::alt_or, p_sub_end - pbegin});
+
+        if (pc == prog.size())
+        {
+          return true;
+        }
+
+        prog[pc_sep].next = pc;
+
+        if (closing)
+        {
+          for (auto i = pc_open; i != pc; i = prog[i].next)
+          {
+            prog[i].close = pc;
+          }
+
+          break;
+        }
+
+        pc_sep = pc;
+        p_sub = cx::next(p_sub_end);
+      }
+
+      p = p_alt_end;
+    }
+    else
+    {
+      // The items up to the next card are pushed as a single literal.
+      auto first = p;
+
+      do
+      {
+        p = cx::next(p);
+      } while (p != pend && !is_card(*p, c));
+
+      prog.push_literal(first - pbegin, p - pbegin);
+    }
+  }
+
+  return open == 0;
+}
+
+// Builds the skip table of the required literal of a program, which gives for the last item of a
+// window of the sequence how far the window can be moved without missing the literal.
+template <typename PatternIterator>
+cfg_constexpr14 void compile_skip(const program& prog, program_tables& tables, PatternIterator p,
+                                  std::true_type)
+{
+  tables.reset_skip(prog.required_length());
+
+  auto distance = prog.required_length();
+
+  for (auto pc = prog.required(); pc != prog.required_end(); ++pc)
+  {
+    for (auto i = prog[pc].first; i != prog[pc].last; ++i)
+    {
+      if (bitmap_index(*(p + i)) >= skip_capacity)
+      {
+        return;
+      }
+
+      if (--distance > 0)
+      {
+        tables.set_skip(bitmap_index(*(p + i)), distance);
+      }
+    }
+  }
+
+  tables.enable_skip();
+}
+
+template <typename PatternIterator>
+cfg_constexpr14 void compile_skip(const program& /*prog*/, program_tables& /*tables*/,
+                                  PatternIterator /*p*/, std::false_type)
+{
+}
+
+// Sets the Shift-And masks of the positions from the first anything of a program without
+// alternatives on. A literal has a position for each of its items, any other instruction has one.
+// A program with more positions than shift_and_positions gets no masks and is backtracked.
+template <typename PatternIterator>
+cfg_constexpr14 void compile_shift_and(const program& prog, program_tables& tables,
+                                       PatternIterator p, std::true_type)
+{
+  auto pc = std::size_t{0};
+
+  while (pc != prog.size() && prog[pc].op != opcode::anything)
+  {
+    ++pc;
+  }
+
+  std::size_t position = 0;
+  std::size_t star_run = 0;
+
+  for (std::size_t run = 0; pc != prog.size(); ++pc)
+  {
+    const auto& in = prog[pc];
+
+    run = in.op == opcode::anything ? run + 1 : 0;
+    star_run = run > star_run ? run : star_run;
+
+    if (position + static_cast<std::size_t>(in.op == opcode::literal ? in.last - in.first : 1) >
+        shift_and_positions)
+    {
+      return;
+    }
+
+    if (in.op == opcode::literal)
+    {
+      for (auto i = in.first; i != in.last; ++i)
+      {
+        if (bitmap_index(*(p + i)) >= shift_and_capacity)
+        {
+          return;
+        }
+
+        tables.set_mask(bitmap_index(*(p + i)), position++);
+      }
+
+      continue;
+    }
+
+    if (in.op == opcode::set && in.next == set_capacity)
+    {
+      return;
+    }
+
+    for (std::size_t index = 0; index <= shift_and_capacity; ++index)
+    {
+      if (in.op != opcode::set || prog.bitmap(in.next).contains(index))
+      {
+        tables.set_mask(index, position);
+      }
+    }
+
+    if (in.op == opcode::anything)
+    {
+      tables.set_star(position);
+    }
+
+    ++position;
+  }
+
+  if (position != 0)
+  {
+    tables.enable_shift_and(position, star_run);
+  }
+}
+
+template <typename PatternIterator>
+cfg_constexpr14 void compile_shift_and(const program& /*prog*/, program_tables& /*tables*/,
+                                       PatternIterator /*p*/, std::false_type)
+{
+}
+
+template <typename PatternIterator, typename Cards>
+cfg_constexpr14 program compile_program(PatternIterator p, PatternIterator pend, const Cards& c)
+{
+  program prog;
+
+  if (!compile_sequence(prog, p, p, pend, c, false))
+  {
+    prog.clear();
+    compile_sequence(prog, p, p, pend, c, true);
+  }
+
+  prog.finish(pend - p);
+
+  return prog;
+}
+
+template <typename PatternIterator>
+cfg_constexpr14 program compile_program(PatternIterator p, PatternIterator pend, cards_type type)
+{
+  return compile_program(p, pend, cards<iterated_item_t<PatternIterator>>(type));
+}
+
+// Compiles the program like the above, but leaves the capacity the pattern does not take
+// uninitialized, so it can be used at runtime only. The program is analyzed unless it is sealed
+// for a single run of a pattern with alternatives, see program::seal.
+template <typename PatternIterator, typename Cards>
+program compile_runtime_program(PatternIterator p, PatternIterator pend, const Cards& c,
+                                bool analyzed)
+{
+  program prog{uninitialized_t{}};
+
+  if (!compile_sequence(prog, p, p, pend, c, false))
+  {
+    prog.clear();
+    compile_sequence(prog, p, p, pend, c, true);
+  }
+
+  if (analyzed)
+  {
+    prog.finish(pend - p);
+  }
+  else
+  {
+    prog.seal(pend - p);
+  }
+
+  return prog;
+}
+
+template <typename PatternIterator, typename Cards>
+constexpr program make_program(PatternIterator p, PatternIterator pend, const Cards& c,
+                               bool analyzed = true)
+{
+#if cfg_HAS_CONSTEXPR14
+
+  return cx::is_constant_evaluated() ? compile_program(p, pend, c)
+                                     : compile_runtime_program(p, pend, c, analyzed);
+
+#else  // !cfg_HAS_CONSTEXPR14
+
+  // A C++11 constexpr constructor cannot compile the program, so it is compiled at runtime only.
+  // The constant evaluation then falls back to matching against the pattern directly.
+  return cx::is_constant_evaluated() ? program{} : compile_runtime_program(p, pend, c, analyzed);
+
+#endif  // cfg_HAS_CONSTEXPR14
+}
+
+// Builds the tables of a program compiled from the pattern starting at p.
+template <typename PatternIterator>
+cfg_constexpr14 program_tables compile_tables(const program& prog, PatternIterator p)
+{
+  program_tables tables;
+
+  if (prog.required_length() > 0)
+  {
+    compile_skip(prog, tables, p, is_bitmap_item<iterated_item_t<PatternIterator>>());
+  }
+
+  if (prog.valid() && !prog.has_alt())
+  {
+    compile_shift_and(prog, tables, p, is_bitmap_item<iterated_item_t<PatternIterator>>());
+  }
+
+  return tables;
+}
+
+template <typename PatternIterator>
+constexpr program_tables make_tables(const program& prog, PatternIterator p)
+{
+#if cfg_HAS_CONSTEXPR14
+
+  return compile_tables(prog, p);
+
+#else  // !cfg_HAS_CONSTEXPR14
+
+  // Like the program, the tables are built at runtime only.
+  return cx::is_constant_evaluated() ? program_tables{} : compile_tables(prog, p);
+
+#endif  // cfg_HAS_CONSTEXPR14
+}
+
+template <typename PatternIterator, typename Cards>
+constexpr compile_error find_compile_error(PatternIterator /*p*/, PatternIterator /*pend*/,
+                                           const Cards& /*c*/)
+{
+  return compile_error{compile_errc::none, 0};
+}
+
+// Whether an item of the sequence can be compared with an item of the pattern without throwing.
+template <typename SequenceIterator, typename PatternIterator, typename EqualTo>
+struct is_nothrow_comparable
+    : std::integral_constant<bool, noexcept(std::declval<const EqualTo&>()(
+                                       *std::declval<SequenceIterator&>(),
+                                       *std::declval<PatternIterator&>()))>
+{
+};
+
+// The bitmap of a set or the skip table of a literal can be used only if the items are compared
+// for the equality of their values.
+template <typename SequenceIterator, typename PatternIterator, typename EqualTo>
+struct compares_values
+    : std::integral_constant<
+          bool, std::is_same<EqualTo, cx::equal_to<void>>::value &&
+                    std::is_same<iterated_item_t<SequenceIterator>,
+                                 iterated_item_t<PatternIterator>>::value &&
+                    is_bitmap_item<iterated_item_t<PatternIterator>>::value>
+{
+};
+
+template <typename T>
+constexpr bool set_bitmap_contains(const program& prog, const instruction& in, const T& item,
+                                   std::true_type)
+{
+  return in.next != set_capacity && prog.bitmap(in.next).contains(item);
+}
+
+template <typename T>
+constexpr bool set_bitmap_contains(const program& /*prog*/, const instruction& /*in*/,
+                                   const T& /*item*/, std::false_type)
+{
+  return false;
+}
+
+// Returns the offset in the pattern where the item fails to match the set, or -1 if it matches.
+template <typename SequenceIterator, typename PatternIterator, typename EqualTo>
+cfg_constexpr14 std::ptrdiff_t set_mismatch(const program& prog, const instruction& in,
+                                            SequenceIterator s, PatternIterator p,
+                                            const EqualTo& equal_to)
+{
+  if (set_bitmap_contains(prog, in, *s,
+                          compares_values<SequenceIterator, PatternIterator, EqualTo>()))
+  {
+    return -1;
+  }
+
+  // A set which has a bitmap and does not contain the item fails either on its closing or, if it
+  // is negated, on the item equal to the given one. The latter has to be looked up.
+  if (compares_values<SequenceIterator, PatternIterator, EqualTo>::value &&
+      in.next != set_capacity && !in.negated)
+  {
+    return in.last;
+  }
+
+  auto i = in.first;
+
+  while (i != in.last && !equal_to(*s, *(p + i)))
+  {
+    ++i;
+  }
+
+  return (in.negated ? i != in.last : i == in.last) ? i : -1;
+}
+
+// The engine which keeps the positions of a mismatch.
+struct diagnostic_engine
+{
+  template <typename SequenceIterator, typename PatternIterator>
+  using result = match_result<SequenceIterator, PatternIterator>;
+
+  template <typename SequenceIterator, typename PatternIterator>
+  static constexpr match_result<SequenceIterator, PatternIterator> make(bool res,
+                                                                        SequenceIterator s,
+                                                                        PatternIterator p)
+  {
+    return make_match_result(res, s, p);
+  }
+};
+
+template <typename SequenceIterator>
+struct test_result
+{
+  bool res;
+  SequenceIterator s;
+
+  constexpr operator bool() const
+  {
+    return res;
+  }
+};
+
+// The engine which only tells whether the sequence matches. It keeps where in the sequence a run
+// ends, which the alternatives need, but none of the positions in the pattern.
+struct test_engine
+{
+  template <typename SequenceIterator, typename PatternIterator>
+  using result = test_result<SequenceIterator>;
+
+  template <typename SequenceIterator, typename PatternIterator>
+  static constexpr test_result<SequenceIterator> make(bool res, SequenceIterator s,
+                                                      PatternIterator /*p*/)
+  {
+    return {res, s};
+  }
+};
+
+template <typename Engine, typename SequenceIterator, typename PatternIterator>
+using engine_result = typename Engine::template result<SequenceIterator, PatternIterator>;
+
+// Remembers no states, see wildcards::memo_buffer.
+struct no_memo
+{
+  constexpr bool failed(std::ptrdiff_t /*rest*/, std::size_t /*pc*/) const
+  {
+    return false;
+  }
+
+  cfg_constexpr14 void fail(std::ptrdiff_t /*rest*/, std::size_t /*pc*/)
+  {
+  }
+};
+
+template <typename Engine = diagnostic_engine, typename SequenceIterator, typename PatternIterator,
+          typename EqualTo, typename Memo>
+cfg_constexpr14 engine_result<Engine, SequenceIterator, PatternIterator> run_memoized(
+    const program& prog, SequenceIterator s, SequenceIterator send, PatternIterator p,
+    std::size_t pc, std::size_t pc_end, const EqualTo& equal_to, bool partial, Memo& memo);
+
+// The end and the partiality of a run are given by the instruction it starts with, so a state of
+// the backtracking is the instruction and the position in the sequence. A memo can remember the
+// states which fail to match. The position of such a mismatch is never reported, since an
+// anything or an alternative reports its own position once none of its ways matches.
+template <typename Engine = diagnostic_engine, typename SequenceIterator, typename PatternIterator,
+          typename EqualTo, typename Memo>
+cfg_constexpr14 engine_result<Engine, SequenceIterator, PatternIterator> run_program(
+    const program& prog, SequenceIterator s, SequenceIterator send, PatternIterator p,
+    std::size_t pc, std::size_t pc_end, const EqualTo& equal_to, bool partial, Memo& memo)
+{
+  while (pc != pc_end)
+  {
+    const auto& in = prog[pc];
+
+    switch (in.op)
+    {
+      case opcode::literal:
+        for (auto i = in.first; i != in.last; ++i)
+        {
+          if (s == send || !equal_to(*s, *(p + i)))
+          {
+            return Engine::make(false, s, p + i);
+          }
+
+          s = cx::next(s);
+        }
+
+        ++pc;
+        break;
+
+      case opcode::single:
+        if (s == send)
+        {
+          return Engine::make(false, s, p + in.first);
+        }
+
+        s = cx::next(s);
+        ++pc;
+        break;
+
+      case opcode::anything:
+        while (true)
+        {
+          auto result =
+              run_memoized<Engine>(prog, s, send, p, pc + 1, pc_end, equal_to, partial, memo);
+
+          if (result)
+          {
+            return result;
+          }
+
+          if (s == send)
+          {
+            return Engine::make(false, s, p + in.first);
+          }
+
+          s = cx::next(s);
+        }
+
+      case opcode::set:
+      {
+        if (s == send)
+        {
+          return Engine::make(false, s, p + in.first);
+        }
+
+        auto i = set_mismatch(prog, in, s, p, equal_to);
+
+        if (i != -1)
+        {
+          return Engine::make(false, s, p + i);
+        }
+
+        s = cx::next(s);
+        ++pc;
+        break;
+      }
+
+      case opcode::alt_open:
+      {
+        auto pc_sub = pc;
+
+        while (true)
+        {
+          auto result1 = run_memoized<Engine>(prog, s, send, p, pc_sub + 1, prog[pc_sub].next,
+                                              equal_to, true, memo);
+
+          if (result1)
+          {
+            auto result2 = run_memoized<Engine>(prog, result1.s, send, p, in.close + 1, pc_end,
+                                                equal_to, partial, memo);
+
+            if (result2)
+            {
+              return result2;
+            }
+          }
+
+          pc_sub = prog[pc_sub].next;
+
+          if (pc_sub == in.close)
+          {
+            return Engine::make(false, s, p + prog[pc_sub].first);
+          }
+        }
+      }
+
+      case opcode::alt_or:
+      case opcode::alt_close:
+        // The separators and the closing of an alternative are never executed, the alternative
+        // is always left via its opening.
+        return Engine::make(false, s, p + in.first);
+    }
+  }
+
+  return Engine::make(partial || s == send, s, p + prog.offset(pc_end));
+}
+
+template <typename Engine, typename SequenceIterator, typename PatternIterator,
+          typename EqualTo, typename Memo>
+cfg_constexpr14 engine_result<Engine, SequenceIterator, PatternIterator> run_memoized(
+    const program& prog, SequenceIterator s, SequenceIterator send, PatternIterator p,
+    std::size_t pc, std::size_t pc_end, const EqualTo& equal_to, bool partial, Memo& memo)
+{
+  if (memo.failed(send - s, pc))
+  {
+    return Engine::make(false, s, p + prog.offset(pc));
+  }
+
+  auto result = run_program<Engine>(prog, s, send, p, pc, pc_end, equal_to, partial, memo);
+
+  if (!result)
+  {
+    memo.fail(send - s, pc);
+  }
+
+  return result;
+}
+
+template <typename Engine = diagnostic_engine, typename SequenceIterator, typename PatternIterator,
+          typename EqualTo>
+cfg_constexpr14 engine_result<Engine, SequenceIterator, PatternIterator> run_program(
+    const program& prog, SequenceIterator s, SequenceIterator send, PatternIterator p,
+    std::size_t pc, std::size_t pc_end, const EqualTo& equal_to, bool partial)
+{
+  no_memo memo;
+
+  return run_program<Engine>(prog, s, send, p, pc, pc_end, equal_to, partial, memo);
+}
+
+// Checks that the sequence ends with the literal suffix of the program. The sequence has to be at
+// least as long as the program requires.
+template <typename SequenceIterator, typename PatternIterator, typename EqualTo>
+cfg_constexpr14 bool suffix_matches(const program& prog, SequenceIterator send, PatternIterator p,
+                                    const EqualTo& equal_to)
+{
+  auto s = send - prog.suffix_length();
+
+  for (auto pc = prog.suffix(); pc != prog.size(); ++pc)
+  {
+    for (auto i = prog[pc].first; i != prog[pc].last; ++i)
+    {
+      if (!equal_to(*s, *(p + i)))
+      {
+        return false;
+      }
+
+      s = cx::next(s);
+    }
+  }
+
+  return true;
+}
+
+template <typename SequenceIterator, typename PatternIterator, typename EqualTo>
+cfg_constexpr14 bool required_at(const program& prog, SequenceIterator s, PatternIterator p,
+                                 const EqualTo& equal_to)
+{
+  for (auto pc = prog.required(); pc != prog.required_end(); ++pc)
+  {
+    for (auto i = prog[pc].first; i != prog[pc].last; ++i)
+    {
+      if (!equal_to(*s, *(p + i)))
+      {
+        return false;
+      }
+
+      s = cx::next(s);
+    }
+  }
+
+  return true;
+}
+
+template <typename T>
+constexpr std::ptrdiff_t required_skip(const program_tables* tables, const T& item,
+                                       std::true_type)
+{
+  return tables != nullptr && tables->has_skip() ? tables->skip(bitmap_index(item)) : 1;
+}
+
+template <typename T>
+constexpr std::ptrdiff_t required_skip(const program_tables* /*tables*/, const T& /*item*/,
+                                       std::false_type)
+{
+  return 1;
+}
+
+// Checks that [s, send) contains the required literal of the program. The windows of the sequence
+// are moved by the skip table of the literal (Horspool) where the tables are given and it can be
+// used, and one by one otherwise.
+template <typename SequenceIterator, typename PatternIterator, typename EqualTo>
+cfg_constexpr14 bool contains_required(const program& prog, SequenceIterator s,
+                                       SequenceIterator send, PatternIterator p,
+                                       const EqualTo& equal_to, const program_tables* tables)
+{
+  auto length = prog.required_length();
+
+  while (send - s >= length)
+  {
+    if (required_at(prog, s, p, equal_to))
+    {
+      return true;
+    }
+
+    s = s + required_skip(tables, *(s + (length - 1)),
+                          compares_values<SequenceIterator, PatternIterator, EqualTo>());
+  }
+
+  return false;
+}
+
+template <typename SequenceIterator, typename T, typename EqualTo>
+cfg_constexpr14 SequenceIterator find_item(SequenceIterator s, SequenceIterator send, const T& item,
+                                           const EqualTo& /*equal_to*/, std::true_type)
+{
+  return cx::find(s, send, item);
+}
+
+template <typename SequenceIterator, typename T, typename EqualTo>
+cfg_constexpr14 SequenceIterator find_item(SequenceIterator s, SequenceIterator send, const T& item,
+                                           const EqualTo& equal_to, std::false_type)
+{
+  while (s != send && !equal_to(*s, item))
+  {
+    s = cx::next(s);
+  }
+
+  return s;
+}
+
+template <typename SequenceIterator>
+SequenceIterator find_member_byte(SequenceIterator s, SequenceIterator send,
+                                  const set_bitmap& bitmap)
+{
+  auto first = reinterpret_cast<const std::uint8_t*>(s);
+
+  return s + (find_any_byte(first, first + (send - s), bitmap.members(), bitmap.size()) - first);
+}
+
+// A few members can be searched by the kernel of the processor, which does not run during
+// constant evaluation.
+template <typename SequenceIterator>
+cfg_constexpr14 SequenceIterator skip_nonmembers(SequenceIterator s, SequenceIterator send,
+                                                 const set_bitmap& bitmap, std::true_type)
+{
+  if (!cx::is_constant_evaluated() && bitmap.size() <= set_members_capacity)
+  {
+    return find_member_byte(s, send, bitmap);
+  }
+
+  return skip_nonmembers(s, send, bitmap, std::false_type());
+}
+
+template <typename SequenceIterator>
+cfg_constexpr14 SequenceIterator skip_nonmembers(SequenceIterator s, SequenceIterator send,
+                                                 const set_bitmap& bitmap, std::false_type)
+{
+  while (s != send && !bitmap.contains(*s))
+  {
+    s = cx::next(s);
+  }
+
+  return s;
+}
+
+template <typename SequenceIterator>
+cfg_constexpr14 SequenceIterator find_member(const program& prog, const instruction& in,
+                                             SequenceIterator s, SequenceIterator send,
+                                             std::true_type)
+{
+  return in.next != set_capacity
+             ? skip_nonmembers(s, send, prog.bitmap(in.next), is_byte_pointer<SequenceIterator>())
+             : s;
+}
+
+template <typename SequenceIterator>
+cfg_constexpr14 SequenceIterator find_member(const program& /*prog*/, const instruction& /*in*/,
+                                             SequenceIterator s, SequenceIterator /*send*/,
+                                             std::false_type)
+{
+  return s;
+}
+
+// Returns the first position in [s, send) where the instruction can start to match or send if
+// there is none. Only a literal or a set with a bitmap rules some positions out, any other
+// instruction returns s.
+template <typename SequenceIterator, typename PatternIterator, typename EqualTo>
+cfg_constexpr14 SequenceIterator next_candidate(const program& prog, std::size_t pc,
+                                                SequenceIterator s, SequenceIterator send,
+                                                PatternIterator p, const EqualTo& equal_to)
+{
+  if (pc == prog.size())
+  {
+    return s;
+  }
+
+  if (prog[pc].op == opcode::literal)
+  {
+    return find_item(s, send, *(p + prog[pc].first), equal_to,
+                     compares_values<SequenceIterator, PatternIterator, EqualTo>());
+  }
+
+  if (prog[pc].op == opcode::set)
+  {
+    return find_member(prog, prog[pc], s, send,
+                       compares_values<SequenceIterator, PatternIterator, EqualTo>());
+  }
+
+  return s;
+}
+
+// Checks that the sequence matches the part of the program run by Shift-And.
+template <typename SequenceIterator>
+cfg_constexpr14 bool run_shift_and(const program_tables& tables, SequenceIterator s,
+                                   SequenceIterator send, std::true_type)
+{
+  if (tables.shift_and_size() == 1)
+  {
+    auto state = tables.shift_and_start();
+
+    while (s != send)
+    {
+      state = tables.shift_and_step(state, bitmap_index(*s));
+      s = cx::next(s);
+    }
+
+    return tables.shift_and_accepts(state);
+  }
+
+  shift_and_state state{};
+
+  tables.shift_and_start(state);
+
+  while (s != send)
+  {
+    tables.shift_and_step(state, bitmap_index(*s));
+    s = cx::next(s);
+  }
+
+  return tables.shift_and_accepts(state);
+}
+
+template <typename SequenceIterator>
+cfg_constexpr14 bool run_shift_and(const program_tables& /*tables*/, SequenceIterator /*s*/,
+                                   SequenceIterator /*send*/, std::false_type)
+{
+  return false;
+}
+
+// Runs a program without alternatives, see wildcards::detail::match_flat. The tables of the
+// program, if given, speed up the search for the required literal and the rest of the matching.
+template <typename Engine = diagnostic_engine, typename SequenceIterator, typename PatternIterator,
+          typename EqualTo>
+cfg_constexpr14 engine_result<Engine, SequenceIterator, PatternIterator> run_flat_program(
+    const program& prog, SequenceIterator s, SequenceIterator send, PatternIterator p,
+    const EqualTo& equal_to, const program_tables* tables = nullptr,
+    prefilter_stats* stats = nullptr)
+{
+  auto sbegin = s;
+  auto star = false;
+  std::size_t first_star_pc = 0;
+  auto star_s = s;
+  std::size_t star_pc = 0;
+  std::size_t pc = 0;
+
+  while (true)
+  {
+    auto result = Engine::make(false, s, p + prog.length());
+
+    if (pc == prog.size())
+    {
+      if (s == send)
+      {
+        return Engine::make(true, s, p + prog.length());
+      }
+    }
+    else
+    {
+      const auto& in = prog[pc];
+
+      switch (in.op)
+      {
+        case opcode::literal:
+        {
+          auto i = in.first;
+
+          while (i != in.last && s != send && equal_to(*s, *(p + i)))
+          {
+            s = cx::next(s);
+            ++i;
+          }
+
+          if (i == in.last)
+          {
+            ++pc;
+            continue;
+          }
+
+          result = Engine::make(false, s, p + i);
+          break;
+        }
+
+        case opcode::single:
+          if (s != send)
+          {
+            s = cx::next(s);
+            ++pc;
+            continue;
+          }
+
+          result = Engine::make(false, s, p + in.first);
+          break;
+
+        case opcode::anything:
+          if (!star)
+          {
+            // Once the first anything is reached, the result of a mismatch is known, so the
+            // sequence can be rejected without backtracking if it is too short, if it does not
+            // end with the literal suffix of the pattern or if it lacks the required literal.
+            if (stats != nullptr)
+            {
+              ++stats->checks;
+            }
+
+            if (send - sbegin < prog.min_length() || !suffix_matches(prog, send, p, equal_to) ||
+                (prog.required_length() > 0 &&
+                 !contains_required(prog, s, send - prog.suffix_length(), p, equal_to, tables)))
+            {
+              if (stats != nullptr)
+              {
+                ++stats->rejections;
+              }
+
+              return Engine::make(false, send, p + in.first);
+            }
+
+            // A program of a simple shape matches once it passes the checks above, otherwise the
+            // rest of it does not need backtracking if it can be run by Shift-And.
+            if (prog.shape() != program_shape::general)
+            {
+              return Engine::make(true, send, p + prog.length());
+            }
+
+            if (compares_values<SequenceIterator, PatternIterator, EqualTo>::value &&
+                tables != nullptr && tables->has_shift_and())
+            {
+              auto res = run_shift_and(
+                  *tables, s, send, compares_values<SequenceIterator, PatternIterator, EqualTo>());
+
+              return Engine::make(res, send, p + (res ? prog.length() : in.first));
+            }
+
+            star = true;
+            first_star_pc = pc;
+          }
+
+          // The positions where the following literal cannot start would fail right away, so they
+          // are skipped at once.
+          s = next_candidate(prog, pc + 1, s, send, p, equal_to);
+          star_s = s;
+          star_pc = pc;
+          ++pc;
+          continue;
+
+        case opcode::set:
+        {
+          if (s == send)
+          {
+            result = Engine::make(false, s, p + in.first);
+            break;
+          }
+
+          auto i = set_mismatch(prog, in, s, p, equal_to);
+
+          if (i == -1)
+          {
+            s = cx::next(s);
+            ++pc;
+            continue;
+          }
+
+          result = Engine::make(false, s, p + i);
+          break;
+        }
+
+        case opcode::alt_open:
+        case opcode::alt_or:
+        case opcode::alt_close:
+          return run_program<Engine>(prog, s, send, p, pc, prog.size(), equal_to, false);
+      }
+    }
+
+    if (!star)
+    {
+      return result;
+    }
+
+    if (star_s == send)
+    {
+      return Engine::make(false, star_s, p + prog[first_star_pc].first);
+    }
+
+    star_s = next_candidate(prog, star_pc + 1, cx::next(star_s), send, p, equal_to);
+    s = star_s;
+    pc = star_pc + 1;
+  }
+}
+
+template <typename Engine = diagnostic_engine, typename SequenceIterator, typename PatternIterator,
+          typename EqualTo>
+cfg_constexpr14 engine_result<Engine, SequenceIterator, PatternIterator> run_program(
+    const program& prog, SequenceIterator s, SequenceIterator send, PatternIterator p,
+    const EqualTo& equal_to, const program_tables* tables = nullptr,
+    prefilter_stats* stats = nullptr)
+{
+  return prog.has_alt() ? run_program<Engine>(prog, s, send, p, 0, prog.size(), equal_to, false)
+                        : run_flat_program<Engine>(prog, s, send, p, equal_to, tables, stats);
+}
+
+// Runs a program remembering the failed states of the backtracking in the given memo. A program
+// without alternatives does not need it.
+template <typename Engine = diagnostic_engine, typename SequenceIterator, typename PatternIterator,
+          typename EqualTo, typename Memo>
+cfg_constexpr14 engine_result<Engine, SequenceIterator, PatternIterator> run_memoized_program(
+    const program& prog, SequenceIterator s, SequenceIterator send, PatternIterator p,
+    const EqualTo& equal_to, const program_tables* tables, Memo& memo)
+{
+  if (!prog.has_alt())
+  {
+    return run_flat_program<Engine>(prog, s, send, p, equal_to, tables);
+  }
+
+  memo.reset(send - s, prog.size());
+
+  return run_program<Engine>(prog, s, send, p, 0, prog.size(), equal_to, false, memo);
+}
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> dispatch_scan(
+    SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator pend,
+    const Cards& c, const EqualTo& equal_to)
+{
+#if cfg_HAS_CONSTEXPR14
+
+  return has_alt(p, pend, c) ? match(s, send, p, pend, c, equal_to)
+                             : match_flat(s, send, p, pend, c, equal_to);
+
+#else  // !cfg_HAS_CONSTEXPR14
+
+  // The engine for patterns without alternatives is not constexpr in C++11, so it is used only at
+  // runtime.
+  return cx::is_constant_evaluated() || has_alt(p, pend, c)
+             ? match(s, send, p, pend, c, equal_to)
+             : match_flat(s, send, p, pend, c, equal_to);
+
+#endif  // cfg_HAS_CONSTEXPR14
+}
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo,
+          typename Memo>
+cfg_constexpr14 match_result<SequenceIterator, PatternIterator> scan_memoized(
+    SequenceIterator s, SequenceIterator send, PatternIterator pbegin, PatternIterator p,
+    PatternIterator pend, const Cards& c, const EqualTo& equal_to, bool partial, Memo& memo);
+
+// Scans the pattern like match() does and remembers the failed states in the memo like
+// run_program() does. The end and the partiality of a scan are given by the position in the
+// pattern it starts at, so a state is that position and the position in the sequence.
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo,
+          typename Memo>
+cfg_constexpr14 match_result<SequenceIterator, PatternIterator> scan_pattern(
+    SequenceIterator s, SequenceIterator send, PatternIterator pbegin, PatternIterator p,
+    PatternIterator pend, const Cards& c, const EqualTo& equal_to, bool partial, Memo& memo)
+{
+  while (p != pend)
+  {
+    if (*p == c.anything)
+    {
+      while (true)
+      {
+        auto result =
+            scan_memoized(s, send, pbegin, cx::next(p), pend, c, equal_to, partial, memo);
+
+        if (result)
+        {
+          return result;
+        }
+
+        if (s == send)
+        {
+          return make_match_result(false, s, p);
+        }
+
+        s = cx::next(s);
+      }
+    }
+
+    if (*p == c.single)
+    {
+      if (s == send)
+      {
+        return make_match_result(false, s, p);
+      }
+    }
+    else if (*p == c.escape)
+    {
+      p = cx::next(p);
+
+      if (p == pend)
+      {
+        break;
+      }
+
+      if (s == send || !equal_to(*s, *p))
+      {
+        return make_match_result(false, s, p);
+      }
+    }
+    else if (c.set_enabled && *p == c.set_open &&
+             is_set(cx::next(p), pend, c, is_set_state::not_or_first))
+    {
+      auto result =
+          match_set(s, send, cx::next(p), pend, c, equal_to, match_set_state::not_or_first_in);
+
+      if (!result)
+      {
+        return result;
+      }
+
+      s = cx::next(s);
+      p = set_end(cx::next(p), pend, c, set_end_state::not_or_first);
+      continue;
+    }
+    else if (c.alt_enabled && *p == c.alt_open &&
+             is_alt(cx::next(p), pend, c, is_alt_state::next, 1))
+    {
+      auto p_alt_end = alt_end(cx::next(p), pend, c, alt_end_state::next, 1);
+
+      while (true)
+      {
+        auto p_sub_end = alt_sub_end(cx::next(p), p_alt_end, c);
+
+        auto result1 =
+            scan_memoized(s, send, pbegin, cx::next(p), p_sub_end, c, equal_to, true, memo);
+
+        if (result1)
+        {
+          auto result2 =
+              scan_memoized(result1.s, send, pbegin, p_alt_end, pend, c, equal_to, partial, memo);
+
+          if (result2)
+          {
+            return result2;
+          }
+        }
+
+        p = p_sub_end;
+
+        if (cx::next(p) == p_alt_end)
+        {
+          return make_match_result(false, s, p);
+        }
+      }
+    }
+    else if (s == send || !equal_to(*s, *p))
+    {
+      return make_match_result(false, s, p);
+    }
+
+    s = cx::next(s);
+    p = cx::next(p);
+  }
+
+  return make_match_result(partial || s == send, s, p);
+}
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo,
+          typename Memo>
+cfg_constexpr14 match_result<SequenceIterator, PatternIterator> scan_memoized(
+    SequenceIterator s, SequenceIterator send, PatternIterator pbegin, PatternIterator p,
+    PatternIterator pend, const Cards& c, const EqualTo& equal_to, bool partial, Memo& memo)
+{
+  auto offset = static_cast<std::size_t>(p - pbegin);
+
+  if (memo.failed(send - s, offset))
+  {
+    return make_match_result(false, s, p);
+  }
+
+  auto result = scan_pattern(s, send, pbegin, p, pend, c, equal_to, partial, memo);
+
+  if (!result)
+  {
+    memo.fail(send - s, offset);
+  }
+
+  return result;
+}
+
+// Scans a pattern the program cannot hold remembering the failed states of the backtracking in
+// the given memo, which is sized by the length of the pattern instead of the program.
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo,
+          typename Memo>
+cfg_constexpr14 match_result<SequenceIterator, PatternIterator> dispatch_memoized_scan(
+    SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator pend,
+    const Cards& c, const EqualTo& equal_to, Memo& memo)
+{
+  if (!has_alt(p, pend, c))
+  {
+    return match_flat(s, send, p, pend, c, equal_to);
+  }
+
+  memo.reset(send - s, static_cast<std::size_t>(pend - p));
+
+  return scan_pattern(s, send, p, p, pend, c, equal_to, false, memo);
+}
+
+// Runs the program of a pattern with an opening card of an alternative. A pattern the program
+// cannot hold is scanned, and so is the rare pattern whose opening cards open no alternative, for
+// which the sealed program is not fit.
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> dispatch_program(
+    SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator pend,
+    const Cards& c, const EqualTo& equal_to, const program& prog)
+{
+  return prog.valid() && prog.has_alt() ? run_program(prog, s, send, p, equal_to)
+                                        : match(s, send, p, pend, c, equal_to);
+}
+
+template <typename SequenceIterator, typename PatternIterator, typename Cards, typename EqualTo>
+constexpr match_result<SequenceIterator, PatternIterator> dispatch_program(
+    SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator pend,
+    const Cards& c, const EqualTo& equal_to)
+{
+  return dispatch_program(s, send, p, pend, c, equal_to, make_program(p, pend, c, false));
+}
+
+template <typename SequenceIterator, typename PatternIterator,
+          typename Cards = cards<iterated_item_t<PatternIterator>>,
+          typename EqualTo = cx::equal_to<void>>
+constexpr match_result<SequenceIterator, PatternIterator> dispatch_match(
+    SequenceIterator s, SequenceIterator send, PatternIterator p, PatternIterator pend,
+    const Cards& c = Cards(), const EqualTo& equal_to = EqualTo())
+{
+  // The program resolves the alternatives once, so the matching itself never scans the pattern for
+  // their ends again. A pattern without an opening card is matched right away by the engine for
+  // patterns without alternatives, which needs no program. A single match does not pay off
+  // building the tables of the program either, those are left to matcher.
+#if cfg_HAS_CONSTEXPR14
+
+  return has_alt_open(p, pend, c) ? dispatch_program(s, send, p, pend, c, equal_to)
+                                  : match_flat(s, send, p, pend, c, equal_to);
+
+#else  // !cfg_HAS_CONSTEXPR14
+
+  // Neither the program nor the engine for patterns without alternatives is constexpr in C++11.
+  return cx::is_constant_evaluated()
+             ? match(s, send, p, pend, c, equal_to)
+             : has_alt_open(p, pend, c) ? dispatch_program(s, send, p, pend, c, equal_to)
+                                        : match_flat(s, send, p, pend, c, equal_to);
+
+#endif  // cfg_HAS_CONSTEXPR14
+}
+
+// A contiguous container of items compared by their values is matched through pointers to its
+// items, so all such containers share the same instantiation of the engines, which then can look
+// the items up by std::memchr. Any other container is matched through its own iterators.
+template <typename C, bool = is_contiguous<const C&>::value &&
+                             is_bitmap_item<container_item_t<const C&>>::value>
+struct lowered_range
+{
+  using iterator = const_iterator_t<const C&>;
+
+  static constexpr iterator begin(const C& c)
+  {
+    return cx::cbegin(c);
+  }
+
+  static constexpr iterator end(const C& c)
+  {
+    return cx::cend(c);
+  }
+};
+
+template <typename C>
+struct lowered_range<C, true>
+{
+  using iterator = const container_item_t<const C&>*;
+
+  static constexpr iterator begin(const C& c)
+  {
+    return cx::data(c);
+  }
+
+  static constexpr iterator end(const C& c)
+  {
+    return cx::data(c) + cx::size(c);
+  }
+};
+
+template <typename C>
+constexpr typename lowered_range<C>::iterator lowered_begin(const C& c)
+{
+  return lowered_range<C>::begin(c);
+}
+
+template <typename C>
+constexpr typename lowered_range<C>::iterator lowered_end(const C& c)
+{
+  return lowered_range<C>::end(c);
+}
+
+// Moves the positions of a result got from the lowered iterators to the original ones.
+template <typename SequenceIterator, typename PatternIterator, typename LoweredSequenceIterator,
+          typename LoweredPatternIterator>
+constexpr match_result<SequenceIterator, PatternIterator> raise_match_result(
+    SequenceIterator s, LoweredSequenceIterator ls, PatternIterator p, LoweredPatternIterator lp,
+    const match_result<LoweredSequenceIterator, LoweredPatternIterator>& mr)
+{
+  return make_match_result(mr.res, s + (mr.s - ls), p + (mr.p - lp));
+}
+
+}  // namespace detail
+
+template <typename Sequence, typename Pattern, typename EqualTo = cx::equal_to<void>>
+constexpr full_match_result<const_iterator_t<Sequence>, const_iterator_t<Pattern>> match(
+    Sequence&& sequence, Pattern&& pattern, const cards<container_item_t<Pattern>>& c,
+    const EqualTo& equal_to = EqualTo())
+{
+  return detail::make_full_match_result(
+      cx::cbegin(sequence), cx::cend(sequence), cx::cbegin(pattern), cx::cend(pattern),
+      detail::raise_match_result(
+          cx::cbegin(sequence), detail::lowered_begin(sequence), cx::cbegin(pattern),
+          detail::lowered_begin(pattern),
+          detail::dispatch_match(detail::lowered_begin(sequence), detail::lowered_end(sequence),
+                                 detail::lowered_begin(pattern), detail::lowered_end(pattern), c,
+                                 equal_to)));
+}
+
+template <typename Sequence, typename Pattern, typename T, T A, T S, T E, T... Extended,
+          typename EqualTo = cx::equal_to<void>>
 constexpr full_match_result<const_iterator_t<Sequence>, const_iterator_t<Pattern>> match(
-    Sequence&& sequence, Pattern&& pattern,
-    const cards<container_item_t<Pattern>>& c = cards<container_item_t<Pattern>>(),
+    Sequence&& sequence, Pattern&& pattern, const static_cards<T, A, S, E, Extended...>& c,
     const EqualTo& equal_to = EqualTo())
 {
   return detail::make_full_match_result(
       cx::cbegin(sequence), cx::cend(sequence), cx::cbegin(pattern), cx::cend(pattern),
-      detail::match(cx::cbegin(sequence), cx::cend(std::forward<Sequence>(sequence)),
-                    cx::cbegin(pattern), cx::cend(std::forward<Pattern>(pattern)), c, equal_to));
+      detail::raise_match_result(
+          cx::cbegin(sequence), detail::lowered_begin(sequence), cx::cbegin(pattern),
+          detail::lowered_begin(pattern),
+          detail::dispatch_match(detail::lowered_begin(sequence), detail::lowered_end(sequence),
+                                 detail::lowered_begin(pattern), detail::lowered_end(pattern), c,
+                                 equal_to)));
 }
 
+// Matches using the default cards, which are the extended ones. They are taken as static cards, so
+// the engines compare the items against constants rather than the members of runtime cards.
 template <typename Sequence, typename Pattern, typename EqualTo = cx::equal_to<void>,
           typename = typename std::enable_if<!std::is_same<EqualTo, cards_type>::value>::type>
 constexpr full_match_result<const_iterator_t<Sequence>, const_iterator_t<Pattern>> match(
-    Sequence&& sequence, Pattern&& pattern, const EqualTo& equal_to)
+    Sequence&& sequence, Pattern&& pattern, const EqualTo& equal_to = EqualTo())
 {
   return match(std::forward<Sequence>(sequence), std::forward<Pattern>(pattern),
-               cards<container_item_t<Pattern>>(), equal_to);
+               extended_cards<container_item_t<Pattern>>(), equal_to);
 }
 
 }  // namespace wildcards
@@ -7,97 +7,498 @@
 #define WILDCARDS_MATCHER_HPP
 
 #include <cstddef>      // std::size_t
-#include <type_traits>  // std::enable_if, std::is_same
+#include <cstdint>      // std::uint64_t
+#include <cstdlib>      // std::abort
+#include <stdexcept>    // std::invalid_argument
+#include <type_traits>  // std::enable_if, std::false_type, std::integral_constant, std::is_same,
+                        // std::true_type
 #include <utility>      // std::forward, std::move
 
+#include "config.hpp"             // cfg_HAS_EXCEPTIONS, cfg_consteval, cfg_constexpr14
 #include "cx/functional.hpp"      // cx::equal_to
-#include "cx/iterator.hpp"        // cx::cbegin, cx::cend
+#include "cx/iterator.hpp"        // cx::cbegin, cx::cend, cx::next
 #include "cx/string_view.hpp"     // cx::make_string_view
-#include "wildcards/cards.hpp"    // wildcards::cards
-#include "wildcards/match.hpp"    // wildcards::detail::make_full_match_result
-                                  // wildcards::detail::match
+#include "wildcards/batch.hpp"    // wildcards::detail::batch_lanes,
+                                  // wildcards::detail::batch_program
+#include "wildcards/cards.hpp"    // wildcards::cards, wildcards::cards_type,
+                                  // wildcards::extended_cards, wildcards::static_cards
+#include "wildcards/dfa.hpp"      // wildcards::detail::dfa_dead_state,
+                                  // wildcards::detail::dfa_start_state,
+                                  // wildcards::detail::dfa_state_capacity,
+                                  // wildcards::detail::lazy_dfa, wildcards::detail::make_lazy_dfa
+#include "wildcards/match.hpp"    // wildcards::compile_error, wildcards::prefilter_stats,
+                                  // wildcards::detail::compares_values,
+                                  // wildcards::detail::dispatch_memoized_scan,
+                                  // wildcards::detail::dispatch_scan,
+                                  // wildcards::detail::find_compile_error,
+                                  // wildcards::detail::is_nothrow_comparable,
+                                  // wildcards::detail::lowered_begin,
+                                  // wildcards::detail::lowered_end,
+                                  // wildcards::detail::make_full_match_result,
+                                  // wildcards::detail::raise_match_result,
+                                  // wildcards::detail::make_program,
+                                  // wildcards::detail::make_tables,
+                                  // wildcards::detail::run_memoized_program,
+                                  // wildcards::detail::run_program,
+                                  // wildcards::detail::test_engine
+#include "wildcards/memo.hpp"     // wildcards::memo_buffer
+#include "wildcards/program.hpp"  // wildcards::detail::bitmap_index,
+                                  // wildcards::detail::is_bitmap_item, wildcards::detail::program,
+                                  // wildcards::detail::program_tables
+#include "wildcards/simd.hpp"     // wildcards::detail::is_byte_pointer
 #include "wildcards/utility.hpp"  // wildcards::const_iterator_t, wildcards::container_item_t,
 
 namespace wildcards
 {
 
-template <typename Pattern, typename EqualTo = cx::equal_to<void>>
+template <typename Pattern, typename EqualTo, typename Cards>
+class lazy_matcher;
+
+template <typename Pattern, typename EqualTo = cx::equal_to<void>,
+          typename Cards = cards<container_item_t<Pattern>>>
 class matcher
 {
+  friend class lazy_matcher<Pattern, EqualTo, Cards>;
+
  public:
-  constexpr explicit matcher(Pattern&& pattern, const cards<container_item_t<Pattern>>& c =
-                                                    cards<container_item_t<Pattern>>(),
+  constexpr explicit matcher(Pattern&& pattern, const Cards& c = Cards(),
                              const EqualTo& equal_to = EqualTo())
       : p_{cx::cbegin(pattern)},
         pend_{cx::cend(std::forward<Pattern>(pattern))},
         c_{c},
-        equal_to_{equal_to}
+        equal_to_{equal_to},
+        prog_{detail::make_program(cx::cbegin(pattern), cx::cend(pattern), c)},
+        tables_{detail::make_tables(prog_, p_)},
+        error_{detail::find_compile_error(p_, pend_, c)}
   {
   }
 
   constexpr matcher(Pattern&& pattern, const EqualTo& equal_to)
       : p_{cx::cbegin(pattern)},
         pend_{cx::cend(std::forward<Pattern>(pattern))},
-        c_{cards<container_item_t<Pattern>>()},
-        equal_to_{equal_to}
+        c_{Cards()},
+        equal_to_{equal_to},
+        prog_{detail::make_program(cx::cbegin(pattern), cx::cend(pattern), Cards())},
+        tables_{detail::make_tables(prog_, p_)},
+        error_{detail::find_compile_error(p_, pend_, Cards())}
   {
   }
 
+  // The first error found in the pattern when the matcher was made. The matches below do not check
+  // the pattern any further, so they throw only if the comparison of the items does.
+  constexpr compile_error error() const
+  {
+    return error_;
+  }
+
+  // Whether the pattern was compiled into a program. A pattern which needs more instructions than a
+  // program holds is matched by the engine scanning the pattern instead.
+  constexpr bool compiled() const
+  {
+    return prog_.valid();
+  }
+
   template <typename Sequence>
   constexpr full_match_result<const_iterator_t<Sequence>, const_iterator_t<Pattern>> matches(
       Sequence&& sequence) const
+      noexcept(detail::is_nothrow_comparable<const_iterator_t<Sequence>,
+                                             const_iterator_t<Pattern>, EqualTo>::value)
+  {
+    return raise_result(sequence, prog_.valid()
+                                      ? detail::run_program(prog_, detail::lowered_begin(sequence),
+                                                            detail::lowered_end(sequence), p_,
+                                                            equal_to_, &tables_)
+                                      : detail::dispatch_scan(detail::lowered_begin(sequence),
+                                                              detail::lowered_end(sequence), p_,
+                                                              pend_, c_, equal_to_));
+  }
+
+  // Tells only whether the sequence matches, so the engine does not keep the positions of a
+  // mismatch. The matches() above reports them when they are needed.
+  template <typename Sequence>
+  constexpr bool test(Sequence&& sequence) const
+      noexcept(detail::is_nothrow_comparable<const_iterator_t<Sequence>,
+                                             const_iterator_t<Pattern>, EqualTo>::value)
+  {
+    return prog_.valid() ? detail::run_program<detail::test_engine>(
+                               prog_, detail::lowered_begin(sequence),
+                               detail::lowered_end(sequence), p_, equal_to_, &tables_)
+                               .res
+                         : detail::dispatch_scan(detail::lowered_begin(sequence),
+                                                 detail::lowered_end(sequence), p_, pend_, c_,
+                                                 equal_to_)
+                               .res;
+  }
+
+  // Matches like the above and records the up-front checks of the compiled program in the stats.
+  template <typename Sequence>
+  constexpr full_match_result<const_iterator_t<Sequence>, const_iterator_t<Pattern>> matches(
+      Sequence&& sequence, prefilter_stats& stats) const
+      noexcept(detail::is_nothrow_comparable<const_iterator_t<Sequence>,
+                                             const_iterator_t<Pattern>, EqualTo>::value)
+  {
+    return raise_result(sequence, prog_.valid()
+                                      ? detail::run_program(prog_, detail::lowered_begin(sequence),
+                                                            detail::lowered_end(sequence), p_,
+                                                            equal_to_, &tables_, &stats)
+                                      : detail::dispatch_scan(detail::lowered_begin(sequence),
+                                                              detail::lowered_end(sequence), p_,
+                                                              pend_, c_, equal_to_));
+  }
+
+  // Matches like the above and remembers the failed states of the backtracking in the buffer, which
+  // keeps the matching of alternatives polynomial. A pattern the program cannot hold is scanned
+  // with the buffer sized by its length.
+  template <typename Sequence>
+  full_match_result<const_iterator_t<Sequence>, const_iterator_t<Pattern>> matches(
+      Sequence&& sequence, memo_buffer& memo) const
+  {
+    return raise_result(sequence, prog_.valid()
+                                      ? detail::run_memoized_program(
+                                            prog_, detail::lowered_begin(sequence),
+                                            detail::lowered_end(sequence), p_, equal_to_, &tables_,
+                                            memo)
+                                      : detail::dispatch_memoized_scan(
+                                            detail::lowered_begin(sequence),
+                                            detail::lowered_end(sequence), p_, pend_, c_,
+                                            equal_to_, memo));
+  }
+
+  // Matches the sequences in blocks of 64 and writes a mask per block to the output iterator, the
+  // bit i of a mask telling whether the sequence i of the block matches. Returns the iterator past
+  // the last mask written. The sequences of bytes of a block are matched at once if the pattern has
+  // no alternatives, otherwise one by one.
+  template <typename Sequences, typename OutputIterator>
+  OutputIterator matches_batch(const Sequences& sequences, OutputIterator out) const
+  {
+    using sequence_iterator = decltype(detail::lowered_begin(*cx::cbegin(sequences)));
+
+    return matches_batch(
+        sequences, out,
+        std::integral_constant<
+            bool, detail::compares_values<sequence_iterator, const_iterator_t<Pattern>,
+                                          EqualTo>::value &&
+                      detail::is_byte_pointer<sequence_iterator>::value>());
+  }
+
+ private:
+  template <typename Sequences, typename OutputIterator>
+  OutputIterator matches_batch(const Sequences& sequences, OutputIterator out,
+                               std::true_type) const
+  {
+    using sequence_iterator = decltype(detail::lowered_begin(*cx::cbegin(sequences)));
+
+    detail::batch_program batch{prog_, p_};
+
+    if (!batch.valid())
+    {
+      return matches_batch(sequences, out, std::false_type());
+    }
+
+    sequence_iterator s[detail::batch_lanes];
+    sequence_iterator send[detail::batch_lanes];
+    std::size_t lanes = 0;
+
+    for (const auto& sequence : sequences)
+    {
+      s[lanes] = detail::lowered_begin(sequence);
+      send[lanes] = detail::lowered_end(sequence);
+
+      if (++lanes == detail::batch_lanes)
+      {
+        *out = batch.run(s, send, lanes);
+        ++out;
+        lanes = 0;
+      }
+    }
+
+    if (lanes != 0)
+    {
+      *out = batch.run(s, send, lanes);
+      ++out;
+    }
+
+    return out;
+  }
+
+  template <typename Sequences, typename OutputIterator>
+  OutputIterator matches_batch(const Sequences& sequences, OutputIterator out,
+                               std::false_type) const
+  {
+    std::uint64_t mask = 0;
+    std::size_t lanes = 0;
+
+    for (const auto& sequence : sequences)
+    {
+      mask |= static_cast<std::uint64_t>(test(sequence)) << lanes;
+
+      if (++lanes == detail::batch_lanes)
+      {
+        *out = mask;
+        ++out;
+        mask = 0;
+        lanes = 0;
+      }
+    }
+
+    if (lanes != 0)
+    {
+      *out = mask;
+      ++out;
+    }
+
+    return out;
+  }
+
+  // A contiguous sequence is matched through pointers to its items, see detail::lowered_range.
+  // The positions of the result are moved back to the iterators of the sequence.
+  template <typename Sequence, typename SequenceIterator>
+  constexpr full_match_result<const_iterator_t<Sequence>, const_iterator_t<Pattern>> raise_result(
+      const Sequence& sequence,
+      const detail::match_result<SequenceIterator, const_iterator_t<Pattern>>& mr) const
   {
     return detail::make_full_match_result(
         cx::cbegin(sequence), cx::cend(sequence), p_, pend_,
-        detail::match(cx::cbegin(sequence), cx::cend(std::forward<Sequence>(sequence)), p_, pend_,
-                      c_, equal_to_));
+        detail::raise_match_result(cx::cbegin(sequence), detail::lowered_begin(sequence), p_, p_,
+                                   mr));
   }
 
- private:
   const_iterator_t<Pattern> p_;
   const_iterator_t<Pattern> pend_;
-  cards<container_item_t<Pattern>> c_;
+  Cards c_;
   EqualTo equal_to_;
+  detail::program prog_;
+  detail::program_tables tables_;
+  compile_error error_;
 };
 
 template <typename Pattern, typename EqualTo = cx::equal_to<void>>
-constexpr matcher<Pattern, EqualTo> make_matcher(
-    Pattern&& pattern,
-    const cards<container_item_t<Pattern>>& c = cards<container_item_t<Pattern>>(),
-    const EqualTo& equal_to = EqualTo())
+constexpr matcher<Pattern, EqualTo> make_matcher(Pattern&& pattern,
+                                                 const cards<container_item_t<Pattern>>& c,
+                                                 const EqualTo& equal_to = EqualTo())
 {
   return matcher<Pattern, EqualTo>{std::forward<Pattern>(pattern), c, equal_to};
 }
 
+// Makes a matcher using the default cards, which are the extended ones taken as static cards like
+// by wildcards::match().
+template <typename Pattern, typename EqualTo = cx::equal_to<void>,
+          typename = typename std::enable_if<!std::is_same<EqualTo, cards_type>::value>::type>
+constexpr matcher<Pattern, EqualTo, extended_cards<container_item_t<Pattern>>> make_matcher(
+    Pattern&& pattern, const EqualTo& equal_to = EqualTo())
+{
+  return make_matcher(std::forward<Pattern>(pattern), extended_cards<container_item_t<Pattern>>(),
+                      equal_to);
+}
+
+template <typename Pattern, typename T, T A, T S, T E, T... Extended,
+          typename EqualTo = cx::equal_to<void>>
+constexpr matcher<Pattern, EqualTo, static_cards<T, A, S, E, Extended...>> make_matcher(
+    Pattern&& pattern, const static_cards<T, A, S, E, Extended...>& c,
+    const EqualTo& equal_to = EqualTo())
+{
+  return matcher<Pattern, EqualTo, static_cards<T, A, S, E, Extended...>>{
+      std::forward<Pattern>(pattern), c, equal_to};
+}
+
+namespace detail
+{
+
+// A static matcher is made during constant evaluation, where an error stops the compilation.
+template <typename Pattern, typename EqualTo, typename Cards>
+constexpr matcher<Pattern, EqualTo, Cards> make_static_matcher(
+    const matcher<Pattern, EqualTo, Cards>& m)
+{
+#if cfg_HAS_EXCEPTIONS
+  return !m.error() ? m : throw std::invalid_argument("The pattern cannot be compiled");
+#else
+  return !m.error() ? m : (std::abort(), m);
+#endif
+}
+
+}  // namespace detail
+
+// Makes a matcher like make_matcher() whose program is compiled when the code is compiled, so it
+// is ready to run and the pattern is not parsed again at runtime. The matcher has to initialize a
+// constexpr variable unless the compiler supports consteval, which makes it compile-time only. A
+// pattern which cannot be compiled does not compile. A C++11 compiler cannot compile the program
+// during constant evaluation, so the matcher matches against the pattern then.
+template <typename Pattern, typename EqualTo = cx::equal_to<void>>
+cfg_consteval matcher<Pattern, EqualTo> make_static_matcher(
+    Pattern&& pattern, const cards<container_item_t<Pattern>>& c,
+    const EqualTo& equal_to = EqualTo())
+{
+  return detail::make_static_matcher(make_matcher(std::forward<Pattern>(pattern), c, equal_to));
+}
+
 template <typename Pattern, typename EqualTo = cx::equal_to<void>,
           typename = typename std::enable_if<!std::is_same<EqualTo, cards_type>::value>::type>
-constexpr matcher<Pattern, EqualTo> make_matcher(Pattern&& pattern, const EqualTo& equal_to)
+cfg_consteval matcher<Pattern, EqualTo, extended_cards<container_item_t<Pattern>>>
+make_static_matcher(Pattern&& pattern, const EqualTo& equal_to = EqualTo())
+{
+  return detail::make_static_matcher(make_matcher(std::forward<Pattern>(pattern), equal_to));
+}
+
+template <typename Pattern, typename T, T A, T S, T E, T... Extended,
+          typename EqualTo = cx::equal_to<void>>
+cfg_consteval matcher<Pattern, EqualTo, static_cards<T, A, S, E, Extended...>> make_static_matcher(
+    Pattern&& pattern, const static_cards<T, A, S, E, Extended...>& c,
+    const EqualTo& equal_to = EqualTo())
+{
+  return detail::make_static_matcher(make_matcher(std::forward<Pattern>(pattern), c, equal_to));
+}
+
+// The matcher of a pattern along with the first error found in the pattern, which converts to
+// true if there is none.
+template <typename Pattern, typename EqualTo = cx::equal_to<void>,
+          typename Cards = cards<container_item_t<Pattern>>>
+struct compile_result
+{
+  matcher<Pattern, EqualTo, Cards> m;
+  compile_error error;
+
+  constexpr operator bool() const
+  {
+    return !error;
+  }
+};
+
+namespace detail
+{
+
+template <typename Pattern, typename EqualTo, typename Cards>
+constexpr compile_result<Pattern, EqualTo, Cards> make_compile_result(
+    const matcher<Pattern, EqualTo, Cards>& m)
+{
+  return {m, m.error()};
+}
+
+}  // namespace detail
+
+// Makes a matcher like make_matcher() and reports the first error found in the pattern, so that a
+// pattern is checked once before it is used to match.
+template <typename Pattern, typename EqualTo = cx::equal_to<void>>
+constexpr compile_result<Pattern, EqualTo> compile(Pattern&& pattern,
+                                                   const cards<container_item_t<Pattern>>& c,
+                                                   const EqualTo& equal_to = EqualTo())
+{
+  return detail::make_compile_result(make_matcher(std::forward<Pattern>(pattern), c, equal_to));
+}
+
+template <typename Pattern, typename EqualTo = cx::equal_to<void>,
+          typename = typename std::enable_if<!std::is_same<EqualTo, cards_type>::value>::type>
+constexpr compile_result<Pattern, EqualTo, extended_cards<container_item_t<Pattern>>> compile(
+    Pattern&& pattern, const EqualTo& equal_to = EqualTo())
+{
+  return detail::make_compile_result(make_matcher(std::forward<Pattern>(pattern), equal_to));
+}
+
+template <typename Pattern, typename T, T A, T S, T E, T... Extended,
+          typename EqualTo = cx::equal_to<void>>
+constexpr compile_result<Pattern, EqualTo, static_cards<T, A, S, E, Extended...>> compile(
+    Pattern&& pattern, const static_cards<T, A, S, E, Extended...>& c,
+    const EqualTo& equal_to = EqualTo())
+{
+  return detail::make_compile_result(make_matcher(std::forward<Pattern>(pattern), c, equal_to));
+}
+
+// A matcher which runs a DFA built on demand from the program of the given matcher, so that it
+// takes a single lookup per item of the sequence. It tells only whether the sequence matches. The
+// backtracking of the given matcher is used instead if the items are not compared by their values,
+// if an alternative has a branch matching a varying number of items or if the DFA runs out of
+// states. The states built are kept for the next sequences, so a lazy_matcher is not thread-safe.
+template <typename Pattern, typename EqualTo, typename Cards>
+class lazy_matcher
+{
+ public:
+  cfg_constexpr14 explicit lazy_matcher(const matcher<Pattern, EqualTo, Cards>& m)
+      : matcher_{m},
+        dfa_{detail::make_lazy_dfa(
+            m.prog_, m.p_,
+            std::integral_constant<
+                bool, std::is_same<EqualTo, cx::equal_to<void>>::value &&
+                          detail::is_bitmap_item<container_item_t<Pattern>>::value>())}
+  {
+  }
+
+  template <typename Sequence>
+  cfg_constexpr14 bool matches(Sequence&& sequence)
+  {
+    return matches(std::forward<Sequence>(sequence),
+                   detail::compares_values<const_iterator_t<Sequence>, const_iterator_t<Pattern>,
+                                           EqualTo>());
+  }
+
+  // The number of the states of the DFA built so far.
+  constexpr std::size_t states() const
+  {
+    return dfa_.size();
+  }
+
+ private:
+  template <typename Sequence>
+  cfg_constexpr14 bool matches(Sequence&& sequence, std::true_type)
+  {
+    if (!dfa_.valid())
+    {
+      return matcher_.test(std::forward<Sequence>(sequence));
+    }
+
+    auto state = detail::dfa_start_state;
+
+    for (auto s = cx::cbegin(sequence); s != cx::cend(sequence) && state != detail::dfa_dead_state;
+         s = cx::next(s))
+    {
+      state = dfa_.next(state, detail::bitmap_index(*s));
+
+      if (state == detail::dfa_state_capacity)
+      {
+        return matcher_.test(std::forward<Sequence>(sequence));
+      }
+    }
+
+    return dfa_.accepting(state);
+  }
+
+  template <typename Sequence>
+  constexpr bool matches(Sequence&& sequence, std::false_type) const
+  {
+    return matcher_.test(std::forward<Sequence>(sequence));
+  }
+
+  matcher<Pattern, EqualTo, Cards> matcher_;
+  detail::lazy_dfa dfa_;
+};
+
+template <typename Pattern, typename EqualTo, typename Cards>
+cfg_constexpr14 lazy_matcher<Pattern, EqualTo, Cards> make_lazy_matcher(
+    const matcher<Pattern, EqualTo, Cards>& m)
 {
-  return make_matcher(std::forward<Pattern>(pattern), cards<container_item_t<Pattern>>(), equal_to);
+  return lazy_matcher<Pattern, EqualTo, Cards>{m};
 }
 
 namespace literals
 {
 
-constexpr auto operator"" _wc(const char* str, std::size_t s)
+cfg_consteval auto operator"" _wc(const char* str, std::size_t s)
     -> decltype(make_matcher(cx::make_string_view(str, s + 1)))
 {
   return make_matcher(cx::make_string_view(str, s + 1));
 }
 
-constexpr auto operator"" _wc(const char16_t* str, std::size_t s)
+cfg_consteval auto operator"" _wc(const char16_t* str, std::size_t s)
     -> decltype(make_matcher(cx::make_string_view(str, s + 1)))
 {
   return make_matcher(cx::make_string_view(str, s + 1));
 }
 
-constexpr auto operator"" _wc(const char32_t* str, std::size_t s)
+cfg_consteval auto operator"" _wc(const char32_t* str, std::size_t s)
     -> decltype(make_matcher(cx::make_string_view(str, s + 1)))
 {
   return make_matcher(cx::make_string_view(str, s + 1));
 }
 
-constexpr auto operator"" _wc(const wchar_t* str, std::size_t s)
+cfg_consteval auto operator"" _wc(const wchar_t* str, std::size_t s)
     -> decltype(make_matcher(cx::make_string_view(str, s + 1)))
 {
   return make_matcher(cx::make_string_view(str, s + 1));
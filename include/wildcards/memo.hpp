@@ -0,0 +1,56 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef WILDCARDS_MEMO_HPP
+#define WILDCARDS_MEMO_HPP
+
+#include <cstddef>  // std::ptrdiff_t, std::size_t
+#include <cstdint>  // std::uint64_t
+#include <vector>   // std::vector
+
+namespace wildcards
+{
+
+// A scratch buffer for matching with memoized backtracking. It keeps a bit for each pair of a
+// position in the sequence and an instruction of the program which tells the pair is known to
+// fail, so no pair is explored twice. The buffer grows to the largest sequence matched with it
+// and is reused by the next ones, so it must not be shared between threads.
+class memo_buffer
+{
+ public:
+  // Clears the bits for a sequence of the given length and a program of the given size.
+  void reset(std::ptrdiff_t length, std::size_t size)
+  {
+    states_ = size + 1;
+    bits_.assign((static_cast<std::size_t>(length + 1) * states_ + 63) / 64, 0);
+  }
+
+  bool failed(std::ptrdiff_t rest, std::size_t pc) const
+  {
+    auto i = index(rest, pc);
+
+    return ((bits_[i / 64] >> (i % 64)) & 1) != 0;
+  }
+
+  void fail(std::ptrdiff_t rest, std::size_t pc)
+  {
+    auto i = index(rest, pc);
+
+    bits_[i / 64] |= std::uint64_t{1} << (i % 64);
+  }
+
+ private:
+  std::size_t index(std::ptrdiff_t rest, std::size_t pc) const
+  {
+    return static_cast<std::size_t>(rest) * states_ + pc;
+  }
+
+  std::vector<std::uint64_t> bits_;
+  std::size_t states_ = 0;
+};
+
+}  // namespace wildcards
+
+#endif  // WILDCARDS_MEMO_HPP
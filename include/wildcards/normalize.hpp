@@ -0,0 +1,276 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef WILDCARDS_NORMALIZE_HPP
+#define WILDCARDS_NORMALIZE_HPP
+
+#include <cstddef>  // std::ptrdiff_t
+#include <utility>  // std::forward
+
+#include "config.hpp"             // cfg_constexpr14
+#include "cx/iterator.hpp"        // cx::cbegin, cx::cend, cx::next, cx::prev
+#include "wildcards/cards.hpp"    // wildcards::cards
+#include "wildcards/match.hpp"    // wildcards::detail::alt_end, wildcards::detail::alt_end_state,
+                                  // wildcards::detail::alt_sub_end, wildcards::detail::is_alt,
+                                  // wildcards::detail::is_alt_state, wildcards::detail::is_card,
+                                  // wildcards::detail::is_set,
+                                  // wildcards::detail::is_set_state, wildcards::detail::set_end,
+                                  // wildcards::detail::set_end_state
+#include "wildcards/utility.hpp"  // wildcards::container_item_t
+
+namespace wildcards
+{
+
+namespace detail
+{
+
+template <typename T, typename OutputIterator, typename Cards>
+cfg_constexpr14 OutputIterator normalize_literal(const T& item, OutputIterator out, const Cards& c)
+{
+  if (is_card(item, c))
+  {
+    *out = c.escape;
+    ++out;
+  }
+
+  *out = item;
+  ++out;
+
+  return out;
+}
+
+// Returns the number of the items matched by the given part of a pattern, or -1 if the number is
+// not fixed.
+template <typename PatternIterator, typename Cards>
+cfg_constexpr14 std::ptrdiff_t fixed_length(PatternIterator p, PatternIterator pend,
+                                            const Cards& c)
+{
+  std::ptrdiff_t length = 0;
+
+  while (p != pend)
+  {
+    if (*p == c.anything)
+    {
+      return -1;
+    }
+
+    if (*p == c.escape)
+    {
+      p = cx::next(p);
+
+      if (p == pend)
+      {
+        break;
+      }
+    }
+    else if (c.set_enabled && *p == c.set_open &&
+             is_set(cx::next(p), pend, c, is_set_state::not_or_first))
+    {
+      p = cx::prev(set_end(cx::next(p), pend, c, set_end_state::not_or_first));
+    }
+    else if (c.alt_enabled && *p == c.alt_open &&
+             is_alt(cx::next(p), pend, c, is_alt_state::next, 1))
+    {
+      auto p_alt_end = alt_end(cx::next(p), pend, c, alt_end_state::next, 1);
+      auto p_sub = cx::next(p);
+      auto branch = fixed_length(p_sub, alt_sub_end(p_sub, p_alt_end, c), c);
+
+      while (true)
+      {
+        auto p_sub_end = alt_sub_end(p_sub, p_alt_end, c);
+
+        if (branch == -1 || fixed_length(p_sub, p_sub_end, c) != branch)
+        {
+          return -1;
+        }
+
+        if (cx::next(p_sub_end) == p_alt_end)
+        {
+          break;
+        }
+
+        p_sub = cx::next(p_sub_end);
+      }
+
+      length += branch;
+      p = p_alt_end;
+
+      continue;
+    }
+
+    ++length;
+    p = cx::next(p);
+  }
+
+  return length;
+}
+
+// The anythings and singles read but not written yet. They are written once an item which is not
+// one of them follows, so the runs on both sides of an inlined alternative become one run.
+struct card_run
+{
+  std::ptrdiff_t singles;
+  bool anything;
+};
+
+template <typename OutputIterator, typename Cards>
+cfg_constexpr14 OutputIterator flush_card_run(card_run& run, OutputIterator out, const Cards& c)
+{
+  for (; run.singles != 0; --run.singles)
+  {
+    *out = c.single;
+    ++out;
+  }
+
+  if (run.anything)
+  {
+    *out = c.anything;
+    ++out;
+    run.anything = false;
+  }
+
+  return out;
+}
+
+template <typename PatternIterator, typename OutputIterator, typename Cards>
+cfg_constexpr14 OutputIterator normalize(PatternIterator p, PatternIterator pend,
+                                         OutputIterator out, const Cards& c, card_run& run)
+{
+  while (p != pend)
+  {
+    if (*p == c.anything)
+    {
+      run.anything = true;
+      p = cx::next(p);
+    }
+    else if (*p == c.single)
+    {
+      ++run.singles;
+      p = cx::next(p);
+    }
+    else if (*p == c.escape)
+    {
+      p = cx::next(p);
+
+      if (p != pend)
+      {
+        out = flush_card_run(run, out, c);
+        out = normalize_literal(*p, out, c);
+        p = cx::next(p);
+      }
+    }
+    else if (c.set_enabled && *p == c.set_open &&
+             is_set(cx::next(p), pend, c, is_set_state::not_or_first))
+    {
+      auto first = cx::next(p);
+      auto negated = *first == c.set_not;
+
+      if (negated)
+      {
+        first = cx::next(first);
+      }
+
+      auto last = cx::prev(set_end(cx::next(p), pend, c, set_end_state::not_or_first));
+      auto single = !negated;
+
+      for (auto i = first; single && i != last; i = cx::next(i))
+      {
+        single = *i == *first;
+      }
+
+      out = flush_card_run(run, out, c);
+
+      if (single)
+      {
+        out = normalize_literal(*first, out, c);
+      }
+      else
+      {
+        for (; p != cx::next(last); p = cx::next(p))
+        {
+          *out = *p;
+          ++out;
+        }
+      }
+
+      p = cx::next(last);
+    }
+    else if (c.alt_enabled && *p == c.alt_open &&
+             is_alt(cx::next(p), pend, c, is_alt_state::next, 1))
+    {
+      auto p_alt_end = alt_end(cx::next(p), pend, c, alt_end_state::next, 1);
+      auto p_sub = cx::next(p);
+
+      // An alternative does not backtrack into its branches once one of them matched, so only a
+      // branch which matches a fixed number of items behaves the same without the parentheses.
+      if (cx::next(alt_sub_end(p_sub, p_alt_end, c)) == p_alt_end &&
+          fixed_length(p_sub, cx::prev(p_alt_end), c) != -1)
+      {
+        out = normalize(p_sub, cx::prev(p_alt_end), out, c, run);
+      }
+      else
+      {
+        out = flush_card_run(run, out, c);
+
+        *out = c.alt_open;
+        ++out;
+
+        while (true)
+        {
+          auto p_sub_end = alt_sub_end(p_sub, p_alt_end, c);
+          card_run sub_run = {0, false};
+
+          out = normalize(p_sub, p_sub_end, out, c, sub_run);
+          out = flush_card_run(sub_run, out, c);
+
+          *out = *p_sub_end;
+          ++out;
+
+          if (cx::next(p_sub_end) == p_alt_end)
+          {
+            break;
+          }
+
+          p_sub = cx::next(p_sub_end);
+        }
+      }
+
+      p = p_alt_end;
+    }
+    else
+    {
+      out = flush_card_run(run, out, c);
+      out = normalize_literal(*p, out, c);
+      p = cx::next(p);
+    }
+  }
+
+  return out;
+}
+
+}  // namespace detail
+
+// Writes the canonical form of the pattern to the output iterator and returns the iterator past
+// the last item written. The canonical form matches the same sequences as the pattern: runs of
+// anythings and singles, including those joined by an inlined alternative, become the singles
+// followed by one anything, items are escaped only if they would be cards, sets of a single item
+// become the item and alternatives of a single branch which matches a fixed number of items become
+// the branch.
+template <typename Pattern, typename OutputIterator>
+cfg_constexpr14 OutputIterator normalize(
+    Pattern&& pattern, OutputIterator out,
+    const cards<container_item_t<Pattern>>& c = cards<container_item_t<Pattern>>())
+{
+  detail::card_run run = {0, false};
+
+  out = detail::normalize(cx::cbegin(pattern), cx::cend(std::forward<Pattern>(pattern)), out, c,
+                          run);
+
+  return detail::flush_card_run(run, out, c);
+}
+
+}  // namespace wildcards
+
+#endif  // WILDCARDS_NORMALIZE_HPP
@@ -0,0 +1,783 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef WILDCARDS_PROGRAM_HPP
+#define WILDCARDS_PROGRAM_HPP
+
+#include <cstddef>      // std::ptrdiff_t, std::size_t
+#include <cstdint>      // std::uint64_t, std::uint8_t
+#include <type_traits>  // std::integral_constant, std::is_integral, std::is_same,
+                        // std::make_unsigned
+
+#include "config.hpp"    // cfg_constexpr14
+#include "cx/array.hpp"  // cx::array
+
+namespace wildcards
+{
+
+namespace detail
+{
+
+enum class opcode
+{
+  literal,
+  single,
+  anything,
+  set,
+  alt_open,
+  alt_or,
+  alt_close
+};
+
+// The shape of a program which decides the way it is run. Any program with an instruction other
+// than a literal or an anything is a general one.
+enum class program_shape
+{
+  general,
+  exact,          // Literals.
+  prefix,         // Literals followed by an anything.
+  suffix,         // An anything followed by literals.
+  prefix_suffix,  // Literals, an anything and literals.
+  contains        // An anything, literals and an anything.
+};
+
+// The default constructor leaves the members uninitialized, so the capacity of a program compiled
+// at runtime costs nothing until it is taken. A value-initialized instruction is a literal at 0.
+struct instruction
+{
+  instruction() = default;
+
+  constexpr instruction(opcode o, std::ptrdiff_t f, std::ptrdiff_t l = 0, bool n = false)
+      : op{o}, first{f}, last{l}, next{0}, close{0}, negated{n}
+  {
+  }
+
+  opcode op;
+
+  // Offsets into the pattern. A literal covers [first, last), a set has its items in [first, last)
+  // and its closing card at last. Any other instruction points to its card by first.
+  std::ptrdiff_t first;
+  std::ptrdiff_t last;
+
+  // Indices into the program. The opening and the separators of an alternative point to the next
+  // separator (or the closing) by next and to the closing by close. A set points to its bitmap by
+  // next, which is set_capacity if the set has none.
+  std::size_t next;
+  std::size_t close;
+
+  bool negated;
+};
+
+constexpr std::size_t program_capacity = 64;
+
+constexpr std::size_t set_capacity = 16;
+
+// The number of items the skip table of the required literal covers.
+constexpr std::size_t skip_capacity = 256;
+
+// The number of items the Shift-And masks cover, the number of words of a Shift-And state and the
+// number of positions it can follow, which leaves a bit for its end. A state which fits into a
+// single word is stepped as such, a longer one carries its shifts over the words.
+constexpr std::size_t shift_and_capacity = 256;
+constexpr std::size_t shift_and_words = 4;
+constexpr std::size_t shift_and_positions = shift_and_words * 64 - 1;
+
+// A Shift-And state of several words, the first one holding the lowest positions.
+using shift_and_state = cx::array<std::uint64_t, shift_and_words>;
+
+// Items which can be looked up in a set bitmap.
+template <typename T>
+struct is_bitmap_item
+    : std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T, bool>::value>
+{
+};
+
+template <typename T>
+constexpr std::size_t bitmap_index(T item)
+{
+  return static_cast<std::size_t>(static_cast<typename std::make_unsigned<T>::type>(item));
+}
+
+// The number of the members of a set which a set bitmap lists, so a sequence of bytes can be
+// searched for them at once.
+constexpr std::size_t set_members_capacity = 8;
+
+// The membership of the items 0 to 255 of a set. Any other item is a member of the set only if
+// the set is negated, so the negation is folded into the bitmap.
+// Like an instruction, a default-initialized bitmap is left uninitialized and a value-initialized
+// one is empty.
+class set_bitmap
+{
+ public:
+  set_bitmap() = default;
+
+  template <typename T>
+  constexpr bool contains(T item) const
+  {
+    return bitmap_index(item) < 256
+               ? ((bits_[bitmap_index(item) / 64] >> (bitmap_index(item) % 64)) & 1) != 0
+               : others_;
+  }
+
+  // Returns the number of the items 0 to 255 which are members of the set.
+  constexpr std::size_t size() const
+  {
+    return size_;
+  }
+
+  // Returns the members of the set if there are at most set_members_capacity of them.
+  constexpr const std::uint8_t* members() const
+  {
+    return members_.begin();
+  }
+
+  cfg_constexpr14 void insert(std::size_t index)
+  {
+    if (contains(index))
+    {
+      return;
+    }
+
+    bits_[index / 64] |= std::uint64_t{1} << (index % 64);
+
+    if (size_ < set_members_capacity)
+    {
+      members_[size_] = static_cast<std::uint8_t>(index);
+    }
+
+    ++size_;
+  }
+
+  cfg_constexpr14 void negate()
+  {
+    for (auto& bits : bits_)
+    {
+      bits = ~bits;
+    }
+
+    size_ = 0;
+
+    for (std::size_t index = 0; index != 256; ++index)
+    {
+      if (contains(index))
+      {
+        if (size_ < set_members_capacity)
+        {
+          members_[size_] = static_cast<std::uint8_t>(index);
+        }
+
+        ++size_;
+      }
+    }
+
+    others_ = !others_;
+  }
+
+ private:
+  cx::array<std::uint64_t, 4> bits_;
+  cx::array<std::uint8_t, set_members_capacity> members_;
+  std::size_t size_;
+  bool others_;
+};
+
+// Selects the constructor of a program which leaves its instructions and bitmaps uninitialized.
+struct uninitialized_t
+{
+};
+
+class program
+{
+ public:
+  constexpr program()
+      : code_{},
+        size_{0},
+        sets_{},
+        sets_size_{0},
+        length_{0},
+        min_length_{0},
+        suffix_{0},
+        suffix_length_{0},
+        required_{0},
+        required_end_{0},
+        required_length_{0},
+        regular_{true},
+        shape_{program_shape::general},
+        valid_{false},
+        overflow_{false},
+        alt_{false}
+  {
+  }
+
+  // Initializes only what the compilation reads before it writes, so a program compiled at runtime
+  // pays only for the instructions and bitmaps its pattern takes. It is not constexpr.
+  explicit program(uninitialized_t)
+      : size_{0},
+        sets_size_{0},
+        length_{0},
+        min_length_{0},
+        suffix_{0},
+        suffix_length_{0},
+        required_{0},
+        required_end_{0},
+        required_length_{0},
+        regular_{true},
+        shape_{program_shape::general},
+        valid_{false},
+        overflow_{false},
+        alt_{false}
+  {
+  }
+
+  constexpr bool valid() const
+  {
+    return valid_;
+  }
+
+  constexpr bool has_alt() const
+  {
+    return alt_;
+  }
+
+  // Whether each branch of each alternative matches a fixed number of items. An alternative takes
+  // the first way its branch matches, which then is the only one, so such a program matches the
+  // same sequences as the corresponding regular expression.
+  constexpr bool regular() const
+  {
+    return regular_;
+  }
+
+  constexpr program_shape shape() const
+  {
+    return shape_;
+  }
+
+  constexpr std::size_t size() const
+  {
+    return size_;
+  }
+
+  constexpr std::ptrdiff_t length() const
+  {
+    return length_;
+  }
+
+  // The minimum number of items a matching sequence has.
+  constexpr std::ptrdiff_t min_length() const
+  {
+    return min_length_;
+  }
+
+  // The first instruction of the literals which end the program and the number of their items.
+  constexpr std::size_t suffix() const
+  {
+    return suffix_;
+  }
+
+  constexpr std::ptrdiff_t suffix_length() const
+  {
+    return suffix_length_;
+  }
+
+  // The instructions [required(), required_end()) are the longest run of literals after the first
+  // anything which does not belong to the suffix. A sequence cannot match unless it contains them.
+  // The run is empty if there is no such literal or if the program has alternatives.
+  constexpr std::size_t required() const
+  {
+    return required_;
+  }
+
+  constexpr std::size_t required_end() const
+  {
+    return required_end_;
+  }
+
+  constexpr std::ptrdiff_t required_length() const
+  {
+    return required_length_;
+  }
+
+  constexpr const instruction& operator[](std::size_t pc) const
+  {
+    return code_[pc];
+  }
+
+  cfg_constexpr14 instruction& operator[](std::size_t pc)
+  {
+    return code_[pc];
+  }
+
+  constexpr const set_bitmap& bitmap(std::size_t index) const
+  {
+    return sets_[index];
+  }
+
+  // Returns the pattern offset corresponding to the given instruction index where the one past the
+  // last instruction corresponds to the end of the pattern.
+  constexpr std::ptrdiff_t offset(std::size_t pc) const
+  {
+    return pc < size_ ? code_[pc].first : length_;
+  }
+
+  cfg_constexpr14 std::size_t push(const instruction& in)
+  {
+    if (size_ == program_capacity)
+    {
+      overflow_ = true;
+      return size_;
+    }
+
+    code_[size_] = in;
+    alt_ = alt_ || in.op == opcode::alt_open;
+
+    return size_++;
+  }
+
+  // Returns the index of the pushed bitmap or set_capacity if there is no room for it, in which
+  // case the set is matched without the bitmap.
+  cfg_constexpr14 std::size_t push_bitmap(const set_bitmap& bitmap)
+  {
+    if (sets_size_ == set_capacity)
+    {
+      return set_capacity;
+    }
+
+    sets_[sets_size_] = bitmap;
+
+    return sets_size_++;
+  }
+
+  // Drops the instructions and the bitmaps, so the program can be compiled again.
+  cfg_constexpr14 void clear()
+  {
+    size_ = 0;
+    sets_size_ = 0;
+    overflow_ = false;
+    alt_ = false;
+  }
+
+  // Pushes the literal [first, last), which extends the last instruction if that is the literal
+  // right before it.
+  cfg_constexpr14 void push_literal(std::ptrdiff_t first, std::ptrdiff_t last)
+  {
+    if (size_ > 0 && code_[size_ - 1].op == opcode::literal && code_[size_ - 1].last == first)
+    {
+      code_[size_ - 1].last = last;
+      return;
+    }
+
+    push(instruction{opcode::literal, first, last});
+  }
+
+  // Ends the compilation without analyzing the program, which suits only a program with
+  // alternatives run once, as their engine needs none of the analysis.
+  cfg_constexpr14 void seal(std::ptrdiff_t length)
+  {
+    length_ = length;
+    valid_ = !overflow_;
+  }
+
+  cfg_constexpr14 void finish(std::ptrdiff_t length)
+  {
+    seal(length);
+
+    if (!valid_)
+    {
+      return;
+    }
+
+    min_length_ = measure(0, size_);
+    shape_ = classify();
+
+    for (std::size_t pc = 0; pc != size_; ++pc)
+    {
+      if (code_[pc].op != opcode::alt_open)
+      {
+        continue;
+      }
+
+      for (auto sep = pc; sep != code_[pc].close; sep = code_[sep].next)
+      {
+        regular_ = regular_ && fixed_length(sep + 1, code_[sep].next) != -1;
+      }
+
+      pc = code_[pc].close;
+    }
+
+    suffix_ = size_;
+
+    while (suffix_ > 0 && code_[suffix_ - 1].op == opcode::literal)
+    {
+      --suffix_;
+      suffix_length_ += code_[suffix_].last - code_[suffix_].first;
+    }
+
+    if (alt_)
+    {
+      return;
+    }
+
+    auto pc = std::size_t{0};
+
+    while (pc != suffix_ && code_[pc].op != opcode::anything)
+    {
+      ++pc;
+    }
+
+    while (pc != suffix_)
+    {
+      if (code_[pc].op != opcode::literal)
+      {
+        ++pc;
+        continue;
+      }
+
+      auto first = pc;
+      std::ptrdiff_t run_length = 0;
+
+      while (pc != suffix_ && code_[pc].op == opcode::literal)
+      {
+        run_length += code_[pc].last - code_[pc].first;
+        ++pc;
+      }
+
+      if (run_length > required_length_)
+      {
+        required_ = first;
+        required_end_ = pc;
+        required_length_ = run_length;
+      }
+    }
+  }
+
+ private:
+  // Returns the minimum number of items matched by the instructions in [pc, pc_end).
+  cfg_constexpr14 std::ptrdiff_t measure(std::size_t pc, std::size_t pc_end) const
+  {
+    std::ptrdiff_t length = 0;
+
+    while (pc != pc_end)
+    {
+      const auto& in = code_[pc];
+
+      if (in.op == opcode::alt_open)
+      {
+        auto shortest = measure(pc + 1, in.next);
+
+        for (auto sep = in.next; sep != in.close; sep = code_[sep].next)
+        {
+          auto sub = measure(sep + 1, code_[sep].next);
+
+          if (sub < shortest)
+          {
+            shortest = sub;
+          }
+        }
+
+        length += shortest;
+        pc = in.close + 1;
+      }
+      else
+      {
+        length += in.op == opcode::literal ? in.last - in.first : in.op == opcode::anything ? 0 : 1;
+        ++pc;
+      }
+    }
+
+    return length;
+  }
+
+  // Returns the shape of the program, see program_shape.
+  cfg_constexpr14 program_shape classify() const
+  {
+    std::size_t stars = 0;
+    std::size_t star = size_;
+
+    for (std::size_t pc = 0; pc != size_; ++pc)
+    {
+      if (code_[pc].op == opcode::anything)
+      {
+        ++stars;
+        star = stars == 1 ? pc : star;
+      }
+      else if (code_[pc].op != opcode::literal)
+      {
+        return program_shape::general;
+      }
+    }
+
+    if (stars == 0)
+    {
+      return program_shape::exact;
+    }
+
+    if (stars == 1)
+    {
+      return star == size_ - 1
+                 ? program_shape::prefix
+                 : star == 0 ? program_shape::suffix : program_shape::prefix_suffix;
+    }
+
+    return stars == 2 && code_[0].op == opcode::anything && code_[size_ - 1].op == opcode::anything
+               ? program_shape::contains
+               : program_shape::general;
+  }
+
+  // Returns the number of items matched by the instructions in [pc, pc_end) or -1 if it is not
+  // fixed.
+  cfg_constexpr14 std::ptrdiff_t fixed_length(std::size_t pc, std::size_t pc_end) const
+  {
+    std::ptrdiff_t length = 0;
+
+    while (pc != pc_end)
+    {
+      const auto& in = code_[pc];
+
+      if (in.op == opcode::anything)
+      {
+        return -1;
+      }
+
+      if (in.op == opcode::alt_open)
+      {
+        auto first = fixed_length(pc + 1, in.next);
+
+        for (auto sep = in.next; sep != in.close; sep = code_[sep].next)
+        {
+          if (fixed_length(sep + 1, code_[sep].next) != first)
+          {
+            return -1;
+          }
+        }
+
+        if (first == -1)
+        {
+          return -1;
+        }
+
+        length += first;
+        pc = in.close + 1;
+      }
+      else
+      {
+        length += in.op == opcode::literal ? in.last - in.first : 1;
+        ++pc;
+      }
+    }
+
+    return length;
+  }
+
+  cx::array<instruction, program_capacity> code_;
+  std::size_t size_;
+  cx::array<set_bitmap, set_capacity> sets_;
+  std::size_t sets_size_;
+  std::ptrdiff_t length_;
+  std::ptrdiff_t min_length_;
+  std::size_t suffix_;
+  std::ptrdiff_t suffix_length_;
+  std::size_t required_;
+  std::size_t required_end_;
+  std::ptrdiff_t required_length_;
+  bool regular_;
+  program_shape shape_;
+  bool valid_;
+  bool overflow_;
+  bool alt_;
+};
+
+// The tables which speed up the matching of a program run many times: the skip table of the
+// required literal and the Shift-And masks. They take more room and time to build than the program
+// itself, so the one-shot matching goes without them.
+class program_tables
+{
+ public:
+  constexpr program_tables()
+      : skip_{},
+        skip_default_{0},
+        skip_enabled_{false},
+        masks_{},
+        stars_{},
+        end_{},
+        words_{0},
+        star_run_{0},
+        shift_and_{false}
+  {
+  }
+
+  // The skip table of the required literal, indexed by the last item of a window of the sequence.
+  // It is available only if all the items of the literal fit into it.
+  constexpr bool has_skip() const
+  {
+    return skip_enabled_;
+  }
+
+  constexpr std::ptrdiff_t skip(std::size_t index) const
+  {
+    return index < skip_capacity ? skip_[index] : skip_default_;
+  }
+
+  // Whether the part of the program from the first anything on can be run by Shift-And. Each
+  // position there is a bit of a state, the first anything being the lowest one.
+  constexpr bool has_shift_and() const
+  {
+    return shift_and_;
+  }
+
+  // The number of words of a state. The states of a single word are stepped by the functions
+  // taking a word, the longer ones by those taking a shift_and_state.
+  constexpr std::size_t shift_and_size() const
+  {
+    return words_;
+  }
+
+  constexpr std::uint64_t shift_and_start() const
+  {
+    return close_stars(1);
+  }
+
+  // Returns the state following the given one on the item of the given bitmap index.
+  constexpr std::uint64_t shift_and_step(std::uint64_t state, std::size_t index) const
+  {
+    return close_stars(((state & mask(index)[0]) << 1) | (state & stars_[0]));
+  }
+
+  constexpr bool shift_and_accepts(std::uint64_t state) const
+  {
+    return (state & end_[0]) != 0;
+  }
+
+  cfg_constexpr14 void shift_and_start(shift_and_state& state) const
+  {
+    state = shift_and_state{};
+    state[0] = 1;
+
+    close_stars(state);
+  }
+
+  // Steps the given state on the item of the given bitmap index. The bit shifted out of a word is
+  // carried into the next one.
+  cfg_constexpr14 void shift_and_step(shift_and_state& state, std::size_t index) const
+  {
+    const auto& m = mask(index);
+    std::uint64_t carry = 0;
+
+    for (std::size_t w = 0; w != words_; ++w)
+    {
+      auto moved = state[w] & m[w];
+
+      state[w] = (moved << 1) | carry | (state[w] & stars_[w]);
+      carry = moved >> 63;
+    }
+
+    close_stars(state);
+  }
+
+  cfg_constexpr14 bool shift_and_accepts(const shift_and_state& state) const
+  {
+    for (std::size_t w = 0; w != words_; ++w)
+    {
+      if ((state[w] & end_[w]) != 0)
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Sets all the skips to the length of the required literal. A skip is kept in a byte, so the
+  // longer skips are cut which only makes the search slower.
+  cfg_constexpr14 void reset_skip(std::ptrdiff_t required_length)
+  {
+    skip_default_ = required_length < 255 ? required_length : 255;
+
+    for (auto& skip : skip_)
+    {
+      skip = static_cast<std::uint8_t>(skip_default_);
+    }
+  }
+
+  // Sets the skip of an item found at the given distance from the end of the required literal.
+  cfg_constexpr14 void set_skip(std::size_t index, std::ptrdiff_t distance)
+  {
+    skip_[index] = static_cast<std::uint8_t>(distance < skip_default_ ? distance : skip_default_);
+  }
+
+  cfg_constexpr14 void enable_skip()
+  {
+    skip_enabled_ = true;
+  }
+
+  // Lets the items of the given bitmap index match the given position. The index shift_and_capacity
+  // stands for all the other items.
+  cfg_constexpr14 void set_mask(std::size_t index, std::size_t position)
+  {
+    masks_[index][position / 64] |= std::uint64_t{1} << (position % 64);
+  }
+
+  cfg_constexpr14 void set_star(std::size_t position)
+  {
+    stars_[position / 64] |= std::uint64_t{1} << (position % 64);
+  }
+
+  // Enables Shift-And for the given number of positions. The stars of a state are closed by as
+  // many steps as there are anythings in the longest run of them.
+  cfg_constexpr14 void enable_shift_and(std::size_t positions, std::size_t star_run)
+  {
+    end_[positions / 64] = std::uint64_t{1} << (positions % 64);
+    words_ = positions / 64 + 1;
+    star_run_ = star_run;
+    shift_and_ = true;
+  }
+
+ private:
+  constexpr const shift_and_state& mask(std::size_t index) const
+  {
+    return masks_[index < shift_and_capacity ? index : shift_and_capacity];
+  }
+
+  // Adds the positions following the active anythings, see enable_shift_and().
+  constexpr std::uint64_t close_stars(std::uint64_t state, std::size_t steps) const
+  {
+    return steps == 0 ? state : close_stars(state | ((state & stars_[0]) << 1), steps - 1);
+  }
+
+  constexpr std::uint64_t close_stars(std::uint64_t state) const
+  {
+    return close_stars(state, star_run_);
+  }
+
+  cfg_constexpr14 void close_stars(shift_and_state& state) const
+  {
+    for (std::size_t step = 0; step != star_run_; ++step)
+    {
+      std::uint64_t carry = 0;
+
+      for (std::size_t w = 0; w != words_; ++w)
+      {
+        auto active = state[w] & stars_[w];
+
+        state[w] |= (active << 1) | carry;
+        carry = active >> 63;
+      }
+    }
+  }
+
+  cx::array<std::uint8_t, skip_capacity> skip_;
+  std::ptrdiff_t skip_default_;
+  bool skip_enabled_;
+  cx::array<shift_and_state, shift_and_capacity + 1> masks_;
+  shift_and_state stars_;
+  shift_and_state end_;
+  std::size_t words_;
+  std::size_t star_run_;
+  bool shift_and_;
+};
+
+}  // namespace detail
+
+}  // namespace wildcards
+
+#endif  // WILDCARDS_PROGRAM_HPP
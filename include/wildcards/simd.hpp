@@ -0,0 +1,334 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef WILDCARDS_SIMD_HPP
+#define WILDCARDS_SIMD_HPP
+
+#include <atomic>       // std::atomic, std::memory_order_relaxed
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint32_t, std::uint64_t, std::uint8_t
+#include <cstring>      // std::memchr
+#include <type_traits>  // std::integral_constant, std::is_integral, std::is_pointer,
+                        // std::is_same, std::remove_cv, std::remove_pointer
+
+#include "config.hpp"             // cfg_HAS_X86_SIMD, cfg_TARGET
+#include "wildcards/program.hpp"  // wildcards::detail::set_members_capacity
+
+#if cfg_HAS_X86_SIMD
+#if defined(_MSC_VER)
+#include <intrin.h>  // __cpuid, __cpuidex, _BitScanForward, _BitScanForward64, _xgetbv
+#endif
+#include <immintrin.h>  // _mm*_cmpeq_epi8*, _mm*_loadu_si*, _mm*_movemask_epi8, _mm*_or_si*,
+                        // _mm*_set1_epi8, _mm*_setzero_si*
+#endif
+
+namespace wildcards
+{
+
+// The instruction sets the kernels of the runtime matching can use, from the least to the most
+// capable one.
+enum class simd_level
+{
+  scalar,
+  sse2,
+  avx2,
+  avx512
+};
+
+namespace detail
+{
+
+// Pointers to bytes can be searched by the kernels.
+template <typename Iterator>
+struct is_byte_pointer
+    : std::integral_constant<
+          bool, std::is_pointer<Iterator>::value &&
+                    std::is_integral<typename std::remove_cv<
+                        typename std::remove_pointer<Iterator>::type>::type>::value &&
+                    !std::is_same<typename std::remove_cv<
+                                      typename std::remove_pointer<Iterator>::type>::type,
+                                  bool>::value &&
+                    sizeof(typename std::remove_pointer<Iterator>::type) == 1>
+{
+};
+
+// Returns the first byte in [first, last) equal to one of the given bytes or last if there is
+// none. The kernels other than the scalar one take at most set_members_capacity bytes.
+using find_any_byte_kernel = const std::uint8_t* (*)(const std::uint8_t* first,
+                                                     const std::uint8_t* last,
+                                                     const std::uint8_t* bytes, std::size_t count);
+
+inline const std::uint8_t* find_any_byte_scalar(const std::uint8_t* first,
+                                                const std::uint8_t* last,
+                                                const std::uint8_t* bytes, std::size_t count)
+{
+  if (count == 1)
+  {
+    auto it = std::memchr(first, bytes[0], static_cast<std::size_t>(last - first));
+
+    return it != nullptr ? static_cast<const std::uint8_t*>(it) : last;
+  }
+
+  for (; first != last; ++first)
+  {
+    for (std::size_t i = 0; i != count; ++i)
+    {
+      if (*first == bytes[i])
+      {
+        return first;
+      }
+    }
+  }
+
+  return last;
+}
+
+#if cfg_HAS_X86_SIMD
+
+inline std::size_t trailing_zeros(std::uint32_t mask)
+{
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return static_cast<std::size_t>(__builtin_ctz(mask));
+#endif
+}
+
+inline std::size_t trailing_zeros(std::uint64_t mask)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanForward64(&index, mask);
+  return index;
+#elif defined(_MSC_VER)
+  return static_cast<std::uint32_t>(mask) != 0
+             ? trailing_zeros(static_cast<std::uint32_t>(mask))
+             : 32 + trailing_zeros(static_cast<std::uint32_t>(mask >> 32));
+#else
+  return static_cast<std::size_t>(__builtin_ctzll(mask));
+#endif
+}
+
+cfg_TARGET("sse2") inline const std::uint8_t* find_any_byte_sse2(const std::uint8_t* first,
+                                                                 const std::uint8_t* last,
+                                                                 const std::uint8_t* bytes,
+                                                                 std::size_t count)
+{
+  __m128i needles[set_members_capacity];
+
+  for (std::size_t i = 0; i != count; ++i)
+  {
+    needles[i] = _mm_set1_epi8(static_cast<char>(bytes[i]));
+  }
+
+  for (; last - first >= 16; first += 16)
+  {
+    auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    auto found = _mm_setzero_si128();
+
+    for (std::size_t i = 0; i != count; ++i)
+    {
+      found = _mm_or_si128(found, _mm_cmpeq_epi8(block, needles[i]));
+    }
+
+    auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(found));
+
+    if (mask != 0)
+    {
+      return first + trailing_zeros(mask);
+    }
+  }
+
+  return find_any_byte_scalar(first, last, bytes, count);
+}
+
+cfg_TARGET("avx2") inline const std::uint8_t* find_any_byte_avx2(const std::uint8_t* first,
+                                                                 const std::uint8_t* last,
+                                                                 const std::uint8_t* bytes,
+                                                                 std::size_t count)
+{
+  __m256i needles[set_members_capacity];
+
+  for (std::size_t i = 0; i != count; ++i)
+  {
+    needles[i] = _mm256_set1_epi8(static_cast<char>(bytes[i]));
+  }
+
+  for (; last - first >= 32; first += 32)
+  {
+    auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+    auto found = _mm256_setzero_si256();
+
+    for (std::size_t i = 0; i != count; ++i)
+    {
+      found = _mm256_or_si256(found, _mm256_cmpeq_epi8(block, needles[i]));
+    }
+
+    auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(found));
+
+    if (mask != 0)
+    {
+      return first + trailing_zeros(mask);
+    }
+  }
+
+  return find_any_byte_scalar(first, last, bytes, count);
+}
+
+cfg_TARGET("avx512f,avx512bw") inline const std::uint8_t* find_any_byte_avx512(
+    const std::uint8_t* first, const std::uint8_t* last, const std::uint8_t* bytes,
+    std::size_t count)
+{
+  __m512i needles[set_members_capacity];
+
+  for (std::size_t i = 0; i != count; ++i)
+  {
+    needles[i] = _mm512_set1_epi8(static_cast<char>(bytes[i]));
+  }
+
+  for (; last - first >= 64; first += 64)
+  {
+    auto block = _mm512_loadu_si512(first);
+    std::uint64_t mask = 0;
+
+    for (std::size_t i = 0; i != count; ++i)
+    {
+      mask |= _mm512_cmpeq_epi8_mask(block, needles[i]);
+    }
+
+    if (mask != 0)
+    {
+      return first + trailing_zeros(mask);
+    }
+  }
+
+  return find_any_byte_scalar(first, last, bytes, count);
+}
+
+#endif  // cfg_HAS_X86_SIMD
+
+inline simd_level detect_simd_level()
+{
+#if cfg_HAS_X86_SIMD && defined(_MSC_VER)
+
+  int info[4];
+
+  __cpuid(info, 0);
+  auto max_leaf = info[0];
+
+  __cpuid(info, 1);
+  auto sse2 = (info[3] & (1 << 26)) != 0;
+  auto osxsave = (info[2] & (1 << 27)) != 0;
+  auto xcr0 = osxsave ? _xgetbv(0) : 0;
+  auto avx2 = false;
+  auto avx512 = false;
+
+  if (max_leaf >= 7)
+  {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x06) == 0x06;
+    avx512 = (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0 && (xcr0 & 0xe6) == 0xe6;
+  }
+
+  return avx512 ? simd_level::avx512
+                : avx2 ? simd_level::avx2 : sse2 ? simd_level::sse2 : simd_level::scalar;
+
+#elif cfg_HAS_X86_SIMD
+
+  __builtin_cpu_init();
+
+  return __builtin_cpu_supports("avx512bw")
+             ? simd_level::avx512
+             : __builtin_cpu_supports("avx2")
+                   ? simd_level::avx2
+                   : __builtin_cpu_supports("sse2") ? simd_level::sse2 : simd_level::scalar;
+
+#else  // !cfg_HAS_X86_SIMD
+
+  return simd_level::scalar;
+
+#endif  // cfg_HAS_X86_SIMD
+}
+
+struct simd_kernels
+{
+  simd_level level;
+  find_any_byte_kernel find_any_byte;
+};
+
+inline const simd_kernels& kernels_of(simd_level level)
+{
+#if cfg_HAS_X86_SIMD
+  static const simd_kernels kernels[] = {{simd_level::scalar, find_any_byte_scalar},
+                                         {simd_level::sse2, find_any_byte_sse2},
+                                         {simd_level::avx2, find_any_byte_avx2},
+                                         {simd_level::avx512, find_any_byte_avx512}};
+
+  return kernels[static_cast<std::size_t>(level)];
+#else
+  static const simd_kernels kernels = {simd_level::scalar, find_any_byte_scalar};
+
+  static_cast<void>(level);
+
+  return kernels;
+#endif
+}
+
+// The processor is asked once.
+inline simd_level detected_simd_level()
+{
+  static const simd_level level = detect_simd_level();
+
+  return level;
+}
+
+// The kernels of the detected level are used until another level is forced.
+inline std::atomic<const simd_kernels*>& active_kernels()
+{
+  static std::atomic<const simd_kernels*> kernels{&kernels_of(detected_simd_level())};
+
+  return kernels;
+}
+
+inline const std::uint8_t* find_any_byte(const std::uint8_t* first, const std::uint8_t* last,
+                                         const std::uint8_t* bytes, std::size_t count)
+{
+  return active_kernels().load(std::memory_order_relaxed)->find_any_byte(first, last, bytes, count);
+}
+
+}  // namespace detail
+
+// Returns the most capable instruction set the processor supports.
+inline simd_level detected_simd_level()
+{
+  return detail::detected_simd_level();
+}
+
+// Returns the instruction set the kernels currently use.
+inline simd_level active_simd_level()
+{
+  return detail::active_kernels().load(std::memory_order_relaxed)->level;
+}
+
+// Makes the kernels use the given instruction set, or the detected one if the processor does not
+// support it, and returns the instruction set used. It is meant for benchmarks and tests which
+// compare the kernels on one machine.
+inline simd_level force_simd_level(simd_level level)
+{
+  if (level > detected_simd_level())
+  {
+    level = detected_simd_level();
+  }
+
+  detail::active_kernels().store(&detail::kernels_of(level), std::memory_order_relaxed);
+
+  return level;
+}
+
+}  // namespace wildcards
+
+#endif  // WILDCARDS_SIMD_HPP
@@ -6,10 +6,11 @@
 #ifndef WILDCARDS_UTILITY_HPP
 #define WILDCARDS_UTILITY_HPP
 
-#include <type_traits>  // std::remove_cv, std::remove_reference
+#include <type_traits>  // std::enable_if, std::false_type, std::is_pointer, std::remove_cv,
+                        // std::remove_reference, std::true_type
 #include <utility>      // std::declval
 
-#include "cx/iterator.hpp"  // cx::begin
+#include "cx/iterator.hpp"  // cx::begin, cx::cbegin, cx::data
 
 namespace wildcards
 {
@@ -54,6 +55,19 @@ struct container_item
 template <typename C>
 using container_item_t = typename container_item<C>::type;
 
+// Containers which store their items in an array reachable by a pointer from cx::data().
+template <typename C, typename = void>
+struct is_contiguous : std::false_type
+{
+};
+
+template <typename C>
+struct is_contiguous<
+    C, typename std::enable_if<std::is_pointer<decltype(cx::data(std::declval<C>()))>::value>::type>
+    : std::true_type
+{
+};
+
 }  // namespace wildcards
 
 #endif  // WILDCARDS_UTILITY_HPP
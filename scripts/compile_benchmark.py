@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+
+# This script measures what the compile-time matching costs the compiler. It
+# generates translation units which each check a number of constexpr matches of
+# one kind of pattern, compiles them using the given C++ standards, and reports
+# the compile time and the peak memory of the compiler for each of them. It
+# fails if any of them exceeds the given budget, so the changes of the engines
+# can be judged on the cost of the compilation too.
+#
+# To know how to use this script: ./compile_benchmark.py --help
+#
+# Copyright Tomas Zeman 2019.
+# Distributed under the Boost Software License, Version 1.0.
+# (See accompanying file LICENSE_1_0.txt or copy at
+# http://www.boost.org/LICENSE_1_0.txt)
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import time
+
+
+# The kinds of the patterns, each giving the sequence and the pattern of the
+# check number i. Each check differs from the others, so the compiler cannot
+# reuse the result of another one.
+KINDS = {
+    'literal': lambda i: ('benchmark_{0}_literal'.format(i),
+                          'benchmark_{0}_literal'.format(i)),
+    'anything': lambda i: ('benchmark_{0}_anything/aaaaaaaab'.format(i),
+                           'bench*_{0}_*/*a*a*b'.format(i)),
+    'set': lambda i: ('Benchmark_{0}_set.hpp'.format(i),
+                      '[Bb]enchmar[!x]_{0}_set.[hc]pp'.format(i)),
+    'alternative': lambda i: ('benchmark_{0}_alt/v2/users'.format(i),
+                              'benchmark_{0}_alt/(v1|v2)/(users|(group|team)s)'.format(i)),
+    'matcher': lambda i: ('benchmark_{0}_matcher/status'.format(i),
+                          'bench?ark_{0}_*/[st]tatus'.format(i)),
+}
+
+
+def generate_unit(kind, count):
+    lines = ['#include "wildcards.hpp"', '']
+
+    for i in range(count):
+        sequence, pattern = KINDS[kind](i)
+
+        if kind == 'matcher':
+            lines.append('constexpr auto m{0} = wildcards::make_matcher("{1}");'.format(i, pattern))
+            lines.append('static_assert(m{0}.matches("{1}"), "");'.format(i, sequence))
+        else:
+            lines.append('static_assert(wildcards::match("{0}", "{1}"), "");'.format(sequence,
+                                                                                  pattern))
+
+    lines.extend(['', 'int main()', '{', '}', ''])
+
+    return '\n'.join(lines)
+
+
+# Runs the command and returns its exit code, the elapsed time in seconds and
+# the peak memory in MiB, or None where the platform does not tell it.
+def run(command, log):
+    start = time.monotonic()
+    process = subprocess.Popen(command, stdout=log, stderr=log)
+
+    if hasattr(os, 'wait4'):
+        _, status, usage = os.wait4(process.pid, 0)
+        elapsed = time.monotonic() - start
+        process.returncode = (os.WEXITSTATUS(status) if os.WIFEXITED(status)
+                              else -os.WTERMSIG(status))
+
+        # The peak resident set size is in KiB on Linux but in bytes on macOS.
+        scale = 1024 * 1024 if sys.platform == 'darwin' else 1024
+
+        return process.returncode, elapsed, usage.ru_maxrss / scale
+
+    process.wait()
+
+    return process.returncode, time.monotonic() - start, None
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Measures the cost of the compile-time matching.')
+    parser.add_argument('--compiler', required=True,
+                        help='the C++ compiler to use')
+    parser.add_argument('--include', required=True,
+                        help='the directory with wildcards.hpp')
+    parser.add_argument('--output', default='compile_benchmark',
+                        help='the directory to put the units, logs and report in')
+    parser.add_argument('--standards', nargs='+', default=['11', '14', '17', '20'],
+                        help='the C++ standards to compile with')
+    parser.add_argument('--kinds', nargs='+', default=sorted(KINDS), choices=sorted(KINDS),
+                        help='the kinds of the patterns to check')
+    parser.add_argument('--count', type=int, default=100,
+                        help='the number of the checks per unit')
+    parser.add_argument('--time-budget', type=float, default=0,
+                        help='the seconds a unit may take to compile, 0 for no budget')
+    parser.add_argument('--memory-budget', type=float, default=0,
+                        help='the MiB the compiler may take for a unit, 0 for no budget')
+    parser.add_argument('--time-trace', action='store_true',
+                        help='let the compiler write a trace of each unit (-ftime-trace)')
+    parser.add_argument('--flags', nargs=argparse.REMAINDER, default=[],
+                        help='the other flags to compile with')
+    args = parser.parse_args()
+
+    os.makedirs(args.output, exist_ok=True)
+
+    results = []
+    failed = False
+
+    print('{0:>4} {1:<12} {2:>10} {3:>10}'.format('std', 'kind', 'time [s]', 'peak [MiB]'))
+
+    for standard in args.standards:
+        for kind in args.kinds:
+            name = 'cxx{0}_{1}'.format(standard, kind)
+            source = os.path.join(args.output, name + '.cpp')
+            log_path = os.path.join(args.output, name + '.log')
+            object_path = os.path.join(args.output, name + '.o')
+
+            with open(source, 'w') as unit:
+                unit.write(generate_unit(kind, args.count))
+
+            command = [args.compiler, '-std=c++' + standard, '-I' + args.include, '-c', '-o',
+                       object_path]
+
+            if args.time_trace:
+                command.append('-ftime-trace')
+
+            command.extend(args.flags)
+            command.append(source)
+
+            with open(log_path, 'w') as log:
+                code, elapsed, peak = run(command, log)
+
+            problems = []
+
+            if code != 0:
+                problems.append('does not compile, see ' + log_path)
+
+            if args.time_budget > 0 and elapsed > args.time_budget:
+                problems.append('exceeds the time budget of {0} s'.format(args.time_budget))
+
+            if args.memory_budget > 0 and peak is not None and peak > args.memory_budget:
+                problems.append('exceeds the memory budget of {0} MiB'.format(args.memory_budget))
+
+            print('{0:>4} {1:<12} {2:>10.2f} {3:>10}'.format(
+                standard, kind, elapsed, '-' if peak is None else '{0:.1f}'.format(peak)))
+
+            for problem in problems:
+                print('     ' + problem)
+
+            failed = failed or bool(problems)
+            results.append({'standard': standard, 'kind': kind, 'count': args.count,
+                            'exit_code': code, 'time': elapsed, 'peak_memory': peak})
+
+    with open(os.path.join(args.output, 'report.json'), 'w') as report:
+        json.dump(results, report, indent=2)
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
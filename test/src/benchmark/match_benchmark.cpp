@@ -0,0 +1,83 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Measures the time the free wildcards::match() and wildcards::matcher::matches() take at runtime
+// for short and typical patterns. Run it with the number of iterations per case, 1000000 by
+// default, and compare the nanoseconds per match between two builds made the same way.
+
+#include <chrono>   // std::chrono::duration, std::chrono::steady_clock
+#include <cstddef>  // std::size_t
+#include <cstdio>   // std::printf
+#include <cstdlib>  // std::strtoul
+#include <cstring>  // std::strlen
+
+#include "cx/string_view.hpp"     // cx::make_string_view
+#include "wildcards/match.hpp"    // wildcards::match
+#include "wildcards/matcher.hpp"  // wildcards::make_matcher
+
+namespace
+{
+
+struct benchmark_case
+{
+  const char* sequence;
+  const char* pattern;
+};
+
+const benchmark_case cases[] = {
+    {"x", "y"},
+    {"abc", "abc"},
+    {"a", "[abc]"},
+    {"source.cpp", "*.cpp"},
+    {"Hello, World!", "H?llo,*W*!"},
+    {"main.hpp", "*.[hc](pp|)"},
+    {"api/v2/users", "api/(v1|v2)/(users|groups)"},
+    {"id=1 user=root group=wheel", "*user=*group=*"},
+};
+
+// Keeps the compiler from dropping the matches.
+volatile bool sink;
+
+template <typename Match>
+double measure(std::size_t iterations, Match match)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  for (std::size_t i = 0; i != iterations; ++i)
+  {
+    sink = match();
+  }
+
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+  return elapsed.count() / static_cast<double>(iterations);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+  std::printf("%-28s %-28s %12s %12s\n", "sequence", "pattern", "match [ns]", "matcher [ns]");
+
+  for (const auto& c : cases)
+  {
+    // The lengths are not known at compile time, so the compiler cannot fold the matches.
+    auto sequence = cx::make_string_view(c.sequence, std::strlen(c.sequence));
+    auto pattern = cx::make_string_view(c.pattern, std::strlen(c.pattern));
+
+    auto m = wildcards::make_matcher(pattern);
+
+    auto free_ns = measure(iterations, [&]() {
+      return static_cast<bool>(wildcards::match(sequence, pattern));
+    });
+    auto matcher_ns = measure(iterations, [&]() { return static_cast<bool>(m.matches(sequence)); });
+
+    std::printf("%-28s %-28s %12.1f %12.1f\n", c.sequence, c.pattern, free_ns, matcher_ns);
+  }
+
+  return 0;
+}
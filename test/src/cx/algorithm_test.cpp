@@ -0,0 +1,91 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <vector>  // std::vector
+
+#include "cx/algorithm.hpp"    // cx::equal, cx::find
+#include "cx/array.hpp"        // cx::array
+#include "cx/string_view.hpp"  // cx::string_view, cx::u32string_view, cx::wstring_view
+
+#include "catch.hpp"
+
+TEST_CASE("cx::equal() is compliant", "[cx::equal]")
+{
+  SECTION("comparing cx::string_views")
+  {
+    constexpr auto s1 = cx::string_view{"Hello, World!"};
+    constexpr auto s2 = cx::string_view{"Hello, World?"};
+
+    static_assert(cx::equal(s1.begin(), s1.end(), s1.begin(), s1.end()), "");
+    static_assert(!cx::equal(s1.begin(), s1.end(), s2.begin(), s2.end()), "");
+    static_assert(!cx::equal(s1.begin(), s1.end() - 1, s1.begin(), s1.end()), "");
+    static_assert(cx::equal(s1.begin(), s1.end() - 1, s2.begin(), s2.end() - 1), "");
+    static_assert(cx::equal(s1.begin(), s1.begin(), s2.end(), s2.end()), "");
+  }
+
+  SECTION("comparing at runtime")
+  {
+    const char s1[] = "user=root\xff";
+    const char s2[] = "user=root\x7f";
+    const wchar_t w1[] = L"user=root";
+    const wchar_t w2[] = L"user=rook";
+    const std::vector<int> v1 = {1, 2, 3};
+    const std::vector<long> v2 = {1, 2, 3};
+
+    REQUIRE(cx::equal(s1, s1 + 10, s1, s1 + 10));
+    REQUIRE(!cx::equal(s1, s1 + 10, s2, s2 + 10));
+    REQUIRE(cx::equal(s1, s1 + 9, s2, s2 + 9));
+    REQUIRE(!cx::equal(s1, s1 + 9, s2, s2 + 10));
+    REQUIRE(cx::equal(s1 + 3, s1 + 3, s2, s2));
+    REQUIRE(cx::equal(w1, w1 + 9, w1, w1 + 9));
+    REQUIRE(!cx::equal(w1, w1 + 9, w2, w2 + 9));
+    REQUIRE(cx::equal(w1, w1 + 8, w2, w2 + 8));
+    REQUIRE(cx::equal(v1.begin(), v1.end(), v2.begin(), v2.end()));
+    REQUIRE(!cx::equal(v1.begin(), v1.end(), v2.begin(), v2.end() - 1));
+  }
+
+  SECTION("comparing cx::string_views and cx::arrays at runtime")
+  {
+    const auto s1 = cx::wstring_view{L"Hello, World!"};
+    const auto s2 = cx::wstring_view{L"Hello, World?"};
+    const cx::array<int, 3> a1 = {{1, 2, 3}};
+    const cx::array<int, 3> a2 = {{1, 2, 4}};
+
+    REQUIRE(s1 == s1);
+    REQUIRE(!(s1 == s2));
+    REQUIRE(a1 == a1);
+    REQUIRE(!(a1 == a2));
+  }
+}
+
+TEST_CASE("cx::find() is compliant", "[cx::find]")
+{
+  SECTION("finding in a cx::string_view")
+  {
+    constexpr auto s = cx::string_view{"Hello, World!"};
+
+    static_assert(cx::find(s.begin(), s.end(), 'o') == s.begin() + 4, "");
+    static_assert(cx::find(s.begin(), s.end(), 'x') == s.end(), "");
+    static_assert(cx::find(s.begin(), s.begin(), 'H') == s.begin(), "");
+  }
+
+  SECTION("finding in a cx::u32string_view")
+  {
+    constexpr auto s = cx::u32string_view{U"Hello, World!"};
+
+    static_assert(cx::find(s.begin(), s.end(), U'o') == s.begin() + 4, "");
+    static_assert(cx::find(s.begin(), s.end(), U'x') == s.end(), "");
+  }
+
+  SECTION("finding at runtime")
+  {
+    const char s[] = "user=root\xff";
+
+    REQUIRE(cx::find(s, s + 10, '=') == s + 4);
+    REQUIRE(cx::find(s, s + 10, '\xff') == s + 9);
+    REQUIRE(cx::find(s, s + 9, '\xff') == s + 9);
+    REQUIRE(cx::find(s + 5, s + 5, 'r') == s + 5);
+  }
+}
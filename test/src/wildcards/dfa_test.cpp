@@ -0,0 +1,118 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "wildcards/dfa.hpp"      // wildcards::detail::dfa_dead_state,
+                                  // wildcards::detail::dfa_start_state,
+                                  // wildcards::detail::dfa_state_capacity,
+                                  // wildcards::detail::lazy_dfa
+#include "cx/iterator.hpp"        // cx::begin, cx::end
+#include "cx/string_view.hpp"     // cx::string_view
+#include "wildcards/cards.hpp"    // wildcards::cards
+#include "wildcards/match.hpp"    // wildcards::match, wildcards::detail::compile_program
+#include "wildcards/matcher.hpp"  // wildcards::make_lazy_matcher, wildcards::make_matcher
+
+#include "catch.hpp"
+
+TEST_CASE("wildcards::detail::lazy_dfa is compliant", "[wildcards::detail::lazy_dfa]")
+{
+  using wildcards::cards;
+  using wildcards::detail::compile_program;
+  using wildcards::detail::dfa_dead_state;
+  using wildcards::detail::dfa_start_state;
+  using wildcards::detail::dfa_state_capacity;
+  using wildcards::detail::lazy_dfa;
+
+  SECTION("stepping through a pattern")
+  {
+    char pattern[] = "a*b";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+    auto dfa = lazy_dfa{prog, cx::begin(pattern)};
+
+    REQUIRE(dfa.valid());
+    REQUIRE(dfa.size() == 2);
+    REQUIRE(!dfa.accepting(dfa_start_state));
+
+    auto state = dfa.next(dfa_start_state, 'a');
+
+    REQUIRE(!dfa.accepting(state));
+    REQUIRE(dfa.next(state, 'x') == state);
+    REQUIRE(dfa.accepting(dfa.next(state, 'b')));
+    REQUIRE(dfa.next(dfa_start_state, 'b') == dfa_dead_state);
+    REQUIRE(dfa.next(dfa_start_state, 'a') == state);
+    REQUIRE(dfa.size() == 4);
+  }
+
+  SECTION("running out of states")
+  {
+    char pattern[] = "*a???????";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+    auto dfa = lazy_dfa{prog, cx::begin(pattern)};
+
+    REQUIRE(dfa.valid());
+
+    auto state = dfa_start_state;
+
+    for (auto n = 0; n != 256 && state != dfa_state_capacity; ++n)
+    {
+      for (auto i = 0; i != 8 && state != dfa_state_capacity; ++i)
+      {
+        state = dfa.next(state, ((n >> i) & 1) != 0 ? 'a' : 'b');
+      }
+    }
+
+    REQUIRE(state == dfa_state_capacity);
+  }
+
+  SECTION("building no DFA for irregular patterns")
+  {
+    char pattern[] = "((a|ab)|x)c";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+
+    REQUIRE(!prog.regular());
+    REQUIRE(!lazy_dfa(prog, cx::begin(pattern)).valid());
+  }
+
+  SECTION("building no DFA for wide items")
+  {
+    char32_t pattern[] = U"*\U0001F600*";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char32_t>());
+
+    REQUIRE(!lazy_dfa(prog, cx::begin(pattern)).valid());
+  }
+}
+
+TEST_CASE("wildcards::lazy_matcher is compliant", "[wildcards::lazy_matcher]")
+{
+  using wildcards::make_lazy_matcher;
+  using wildcards::make_matcher;
+
+  cx::string_view patterns[] = {
+      "",          "A",        R"(A\)",       "*",          "?",           "H?llo,*W*!",
+      "*a*a*b",    "[abc]*",   "[!abc]?",     "a[]]a",      "a(X|Y)b",     "(a(X|Y)b|c)",
+      "a()a",      "(abc|)",   "*.[hc](pp|)", "(*a|b)c",    "((a|ab)|x)c", "*(a|b)*c",
+      "(ab|a)*bc", "*[!abc]*", "*ll*o*",      "*(b|c)(d|e)"};
+
+  cx::string_view sequences[] = {"",      "A",         "a",           "*",      "Hello, World!",
+                                 "aaaab", "aaaaa",     "cab",         "a]a",    "aXb",
+                                 "aZb",   "c",         "aa",          "abc",    "source.cpp",
+                                 "bc",    "xc",        "ac",          "abbc",   "source.h",
+                                 "abcbd", "zzabxzzc",  "source.hpp"};
+
+  for (const auto& p : patterns)
+  {
+    auto m = make_matcher(p);
+    auto lazy = make_lazy_matcher(m);
+
+    for (const auto& s : sequences)
+    {
+      INFO("pattern: " << p << ", sequence: " << s);
+      REQUIRE(lazy.matches(s) == m.matches(s).res);
+    }
+  }
+}
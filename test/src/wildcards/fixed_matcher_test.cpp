@@ -0,0 +1,95 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "config.hpp"  // cfg_HAS_CLASS_NTTP
+
+#if cfg_HAS_CLASS_NTTP
+
+#include <cstddef>  // std::size_t
+#include <deque>    // std::deque
+#include <string>   // std::string
+
+#include "wildcards/fixed_matcher.hpp"  // wildcards::fixed_matcher, wildcards::fixed_pattern
+#include "cx/string_view.hpp"           // cx::string_view
+#include "wildcards/matcher.hpp"        // wildcards::make_matcher
+
+#include "catch.hpp"
+
+namespace
+{
+
+const std::string sequences[] = {"",
+                                 "api/v1/users/status",
+                                 "api/v2/x/status",
+                                 "api/v2//status",
+                                 "api/v12/users/status",
+                                 "api/v1/users/status/",
+                                 "api/v1/status",
+                                 "source.cpp",
+                                 "source.hpp",
+                                 "source.h",
+                                 "aaaab",
+                                 "aaaaa",
+                                 "a*b",
+                                 "ab",
+                                 "abcabcabd"};
+
+template <wildcards::fixed_pattern Pattern>
+void require_same_as_matcher()
+{
+  const wildcards::fixed_matcher<Pattern> fixed;
+  const auto m = wildcards::make_matcher(cx::string_view{
+      Pattern.begin(), static_cast<std::size_t>(Pattern.end() - Pattern.begin())});
+
+  for (const auto& s : sequences)
+  {
+    const std::deque<char> d(s.begin(), s.end());
+
+    INFO("pattern: " << Pattern.begin() << ", sequence: " << s);
+    REQUIRE(fixed.test(s) == m.test(s));
+    REQUIRE(fixed.test(d) == m.test(s));
+
+    const auto result = fixed.matches(s);
+    const auto expected = m.matches(s);
+
+    REQUIRE(result.res == expected.res);
+    REQUIRE(result.s1 == expected.s1);
+    REQUIRE(result.p1 - result.p == expected.p1 - expected.p);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("wildcards::fixed_matcher is compliant", "[wildcards::fixed_matcher]")
+{
+  using wildcards::fixed_matcher;
+
+  SECTION(R"(matching "api/v?/*/status")")
+  {
+    constexpr fixed_matcher<"api/v?/*/status"> pattern;
+
+    static_assert(pattern.test(cx::string_view{"api/v1/users/status"}), "");
+    static_assert(!pattern.test(cx::string_view{"api/v1/users/state"}), "");
+    static_assert(pattern.matches(cx::string_view{"api/v1/users/status"}), "");
+  }
+
+  SECTION("matching like a matcher")
+  {
+    require_same_as_matcher<"">();
+    require_same_as_matcher<"*">();
+    require_same_as_matcher<"api/v?/*/status">();
+    require_same_as_matcher<"api/*">();
+    require_same_as_matcher<"*status">();
+    require_same_as_matcher<"*.[hc]pp">();
+    require_same_as_matcher<"*.[!c]*">();
+    require_same_as_matcher<"*a*a*b">();
+    require_same_as_matcher<"*abc*abd">();
+    require_same_as_matcher<R"(a\*b)">();
+    require_same_as_matcher<"?*?">();
+    require_same_as_matcher<"*.[hc](pp|)">();
+  }
+}
+
+#endif  // cfg_HAS_CLASS_NTTP
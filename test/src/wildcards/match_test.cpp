@@ -3,13 +3,24 @@
 // (See accompanying file LICENSE_1_0.txt or copy at
 // http://www.boost.org/LICENSE_1_0.txt)
 
-#include "wildcards/match.hpp"  // wildcards::cards, wildcards::cards_type,
-                                // wildcards::detail::alt_end, wildcards::detail::is_alt,
-                                // wildcards::detail::is_set, wildcards::detail::match_set,
-                                // wildcards::detail::set_end, wildcards::match
-#include "cx/array.hpp"         // cx::array
-#include "cx/iterator.hpp"      // cx::begin, cx::end
-#include "cx/string_view.hpp"   // cx::literals
+#include <cstddef>  // std::ptrdiff_t
+#include <deque>    // std::deque
+#include <string>   // std::string
+#include <vector>   // std::vector
+
+#include "config.hpp"             // cfg_HAS_CONSTEXPR14, cfg_constexpr14
+#include "wildcards/match.hpp"    // wildcards::cards, wildcards::cards_type,
+                                  // wildcards::detail::alt_end, wildcards::detail::has_alt,
+                                  // wildcards::detail::is_alt, wildcards::detail::is_set,
+                                  // wildcards::detail::match_flat, wildcards::detail::match_set,
+                                  // wildcards::detail::set_end, wildcards::extended_cards,
+                                  // wildcards::match, wildcards::standard_cards,
+                                  // wildcards::static_cards
+#include "cx/algorithm.hpp"       // cx::equal, cx::find
+#include "cx/array.hpp"           // cx::array
+#include "cx/iterator.hpp"        // cx::begin, cx::end
+#include "cx/string_view.hpp"     // cx::literals, cx::string_view
+#include "wildcards/utility.hpp"  // wildcards::is_contiguous
 
 #include "catch.hpp"
 
@@ -617,6 +628,153 @@ TEST_CASE("wildcards::detail::alt_end() is compliant", "[wildcards::detail::alt_
   }
 }
 
+TEST_CASE("wildcards::detail::has_alt() is compliant", "[wildcards::detail::has_alt]")
+{
+  using wildcards::cards_type;
+  using wildcards::detail::has_alt;
+
+  char pattern1[] = "*.(c|h)";
+  char pattern2[] = "a(b";
+  char pattern3[] = R"(\(a|b))";
+  char pattern4[] = "[(]a|b)";
+  char pattern5[] = "*.[hc]";
+
+  REQUIRE(has_alt(cx::begin(pattern1), cx::end(pattern1)));
+  REQUIRE(!has_alt(cx::begin(pattern2), cx::end(pattern2)));
+  REQUIRE(!has_alt(cx::begin(pattern3), cx::end(pattern3)));
+  REQUIRE(!has_alt(cx::begin(pattern4), cx::end(pattern4)));
+  REQUIRE(!has_alt(cx::begin(pattern5), cx::end(pattern5)));
+
+  REQUIRE(!has_alt(cx::begin(pattern1), cx::end(pattern1), cards_type::standard));
+}
+
+TEST_CASE("wildcards::detail::match_flat() is compliant", "[wildcards::detail::match_flat]")
+{
+  using wildcards::detail::match;
+  using wildcards::detail::match_flat;
+
+  SECTION("matching as wildcards::detail::match()")
+  {
+    cx::string_view patterns[] = {"",       "A",      R"(A\)",   R"(\*)",   "*",
+                                  "?",      "**",     "H?llo,*W*!", "*a*a*b", "[abc]*",
+                                  "[!abc]?", "a[]]a", "a[!]a",    "*[]]*",   R"(*\?)"};
+
+    cx::string_view sequences[] = {"",      "A",     "a",     "*",      "Hello, World!",
+                                   "aaaab", "aaaaa", "cab",   "xy",     "a]a",
+                                   "a!a",   "]",     "x]y",   "abc?",   "?"};
+
+    for (const auto& p : patterns)
+    {
+      for (const auto& s : sequences)
+      {
+        auto expected = match(s.begin(), s.end(), p.begin(), p.end());
+        auto result = match_flat(s.begin(), s.end(), p.begin(), p.end());
+
+        INFO("pattern: " << p << ", sequence: " << s);
+        REQUIRE(result.res == expected.res);
+        REQUIRE(result.s == expected.s);
+        REQUIRE(result.p == expected.p);
+      }
+    }
+  }
+
+  SECTION("matching pathological patterns")
+  {
+    char sequence[] = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+                      "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+                      "aaaaaaaa";
+    char pattern[] = "*a*a*a*a*a*a*a*a*a*a*b";
+
+    REQUIRE(!match_flat(cx::begin(sequence), cx::end(sequence) - 1, cx::begin(pattern),
+                        cx::end(pattern) - 1));
+    REQUIRE(!wildcards::match(sequence, pattern));
+  }
+}
+
+namespace
+{
+
+// A sequence of "Test_" followed by the items 'a' and ended by the given item. Its items are
+// computed rather than stored, so it can be long enough to test the depth of the constexpr
+// evaluation.
+class long_sequence
+{
+ public:
+  class iterator
+  {
+   public:
+    constexpr iterator() : index_{0}, size_{0}, last_{'\0'}
+    {
+    }
+
+    constexpr iterator(std::ptrdiff_t index, std::ptrdiff_t size, char last)
+        : index_{index}, size_{size}, last_{last}
+    {
+    }
+
+    constexpr char operator*() const
+    {
+      return index_ < 5 ? "Test_"[index_] : index_ == size_ - 1 ? last_ : 'a';
+    }
+
+    constexpr iterator operator+(std::ptrdiff_t n) const
+    {
+      return {index_ + n, size_, last_};
+    }
+
+    constexpr iterator operator-(std::ptrdiff_t n) const
+    {
+      return {index_ - n, size_, last_};
+    }
+
+    constexpr std::ptrdiff_t operator-(const iterator& other) const
+    {
+      return index_ - other.index_;
+    }
+
+    cfg_constexpr14 iterator& operator++()
+    {
+      ++index_;
+      return *this;
+    }
+
+    constexpr bool operator==(const iterator& other) const
+    {
+      return index_ == other.index_;
+    }
+
+    constexpr bool operator!=(const iterator& other) const
+    {
+      return index_ != other.index_;
+    }
+
+   private:
+    std::ptrdiff_t index_;
+    std::ptrdiff_t size_;
+    char last_;
+  };
+
+  constexpr long_sequence(std::ptrdiff_t size, char last) : size_{size}, last_{last}
+  {
+  }
+
+  constexpr iterator begin() const
+  {
+    return {0, size_, last_};
+  }
+
+  constexpr iterator end() const
+  {
+    return {size_, size_, last_};
+  }
+
+ private:
+  std::ptrdiff_t size_;
+  char last_;
+};
+
+}  // namespace
+
 TEST_CASE("wildcards::match() is compliant", "[wildcards::match]")
 {
   using wildcards::match;
@@ -907,6 +1065,44 @@ TEST_CASE("wildcards::match() is compliant", "[wildcards::match]")
     static_assert(match("Hello, World!", pattern, {'%', '_', '\\'}), "");
   }
 
+  SECTION(R"(matching "H_llo,%W%!" using static cards)")
+  {
+    using wildcards::static_cards;
+
+    constexpr char pattern[] = "H_llo,%W%!";
+
+    static_assert(match("Hello, World!", pattern, static_cards<char, '%', '_', '\\'>()), "");
+    static_assert(!match("Hello, World?", pattern, static_cards<char, '%', '_', '\\'>()), "");
+  }
+
+  SECTION(R"(matching "[HJ]ello, (W|w)orld!" using static cards)")
+  {
+    using wildcards::extended_cards;
+    using wildcards::standard_cards;
+    using wildcards::static_cards;
+
+    constexpr char pattern[] = "[HJ]ello, (W|w)orld!";
+
+    static_assert(match("Jello, world!", pattern, extended_cards<char>()), "");
+    static_assert(!match("Jello, world!", pattern, standard_cards<char>()), "");
+    static_assert(match("[HJ]ello, (W|w)orld!", pattern, standard_cards<char>()), "");
+    static_assert(match("Jello, world!", "<HJ>ello, {W/w}orld!",
+                        static_cards<char, '*', '?', '\\', '<', '>', '!', '{', '}', '/'>()),
+                  "");
+  }
+
+  SECTION("matching using the default cards")
+  {
+    // Items lacking a specialization of wildcards::cards have no default runtime cards, so these
+    // compile only if the default cards are the static extended ones.
+    constexpr cx::array<int, 3> pattern{{'a', '*', '?'}};
+
+    static_assert(match(cx::array<int, 3>{{'a', 'b', 'c'}}, pattern), "");
+    static_assert(!match(cx::array<int, 2>{{'b', 'c'}}, pattern), "");
+    static_assert(
+        match(cx::array<int, 3>{{'a', 'b', 'c'}}, pattern, wildcards::extended_cards<int>()), "");
+  }
+
   SECTION(R"(matching "H?llo,*W*!"_sv)")
   {
     using namespace cx::literals;
@@ -1030,4 +1226,93 @@ TEST_CASE("wildcards::match() is compliant", "[wildcards::match]")
     static_assert(match("aa", "a()a"), "");
     static_assert(match("", "(abc|)"), "");
   }
+
+  SECTION("matching many alternatives")
+  {
+    static_assert(match("abababababababababab",
+                        "(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)"
+                        "(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)"),
+                  "");
+    static_assert(!match("abababababababababab",
+                         "(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)"
+                         "(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)c"),
+                  "");
+    static_assert(!match("abababababababababab", "*(a|b)*(a|b)*(a|b)*c"), "");
+  }
+
+#if cfg_HAS_CONSTEXPR14
+  SECTION("matching long sequences")
+  {
+    std::string sequence(1024 * 1024, 'a');
+
+    sequence += "end";
+
+    REQUIRE(match(sequence, std::string{"a(a|b)*(end|fin)"}));
+    REQUIRE(!match(sequence, std::string{"a(a|b)*(begin|start)"}));
+  }
+#endif
+
+  SECTION("matching contiguous containers")
+  {
+    using wildcards::is_contiguous;
+
+    static_assert(is_contiguous<const std::string&>::value, "");
+    static_assert(is_contiguous<const std::vector<char>&>::value, "");
+    static_assert(is_contiguous<const char (&)[4]>::value, "");
+    static_assert(!is_contiguous<const std::deque<char>&>::value, "");
+
+    const std::string pattern = "H?llo,*W*(o|a)*d!";
+    const std::string text[] = {"Hello, World!", "Hello, Word", "Hallo, Welt!", "Hi"};
+
+    for (const auto& t : text)
+    {
+      const std::vector<char> chars(t.begin(), t.end());
+      const std::deque<char> reference(t.begin(), t.end());
+
+      const auto expected = match(reference, pattern);
+      const auto result1 = match(t, pattern);
+      const auto result2 = match(chars, pattern);
+
+      INFO("sequence: " << t);
+      REQUIRE(result1.res == expected.res);
+      REQUIRE(result1.s1 - result1.s == expected.s1 - expected.s);
+      REQUIRE(result1.p1 - result1.p == expected.p1 - expected.p);
+      REQUIRE(result2.res == expected.res);
+      REQUIRE(result2.s1 - result2.s == expected.s1 - expected.s);
+      REQUIRE(result2.p1 - result2.p == expected.p1 - expected.p);
+    }
+  }
+
+  SECTION("matching nested alternatives")
+  {
+    static_assert(match("route/v2/users/42", "route/(v1|v2)/(users|(group|team)s)/*"), "");
+    static_assert(match("route/v1/teams/7", "route/(v1|v2)/(users|(group|team)s)/*"), "");
+    static_assert(!match("route/v3/teams/7", "route/(v1|v2)/(users|(group|team)s)/*"), "");
+    static_assert(match("a]b", "a((x|[]])|(y|z))b"), "");
+  }
+
+  SECTION("matching long sequences at compile time")
+  {
+    using namespace cx::literals;
+
+    // 10,000 items, which no compiler would let a recursion per item go through.
+    constexpr auto sequence = long_sequence{10000, 'b'};
+    constexpr auto pattern = long_sequence{10000, '?'};
+    constexpr auto prefix = "Test_aab"_sv;
+
+    static_assert(match(sequence, "[Tt]est_*"_sv), "");
+    static_assert(match(sequence, "*b"_sv), "");
+    static_assert(match(sequence, "[Tt]est_*a*b"_sv), "");
+    static_assert(!match(sequence, "[Tt]est_*c*"_sv), "");
+    static_assert(!match(sequence, "*ab?"_sv), "");
+    static_assert(match(sequence, pattern), "");
+    static_assert(!match(sequence, long_sequence{10000, 'c'}), "");
+    static_assert(match(sequence, "*"_sv).s1 == sequence.end(), "");
+    static_assert(match(sequence, "*c"_sv).s1 == sequence.end(), "");
+    static_assert(match(sequence, prefix).s1 == sequence.begin() + 7, "");
+    static_assert(match(sequence, prefix).p1 == prefix.begin() + 7, "");
+    static_assert(cx::equal(sequence.begin(), sequence.end(), sequence.begin(), sequence.end()),
+                  "");
+    static_assert(cx::find(sequence.begin(), sequence.end(), 'b') == sequence.end() - 1, "");
+  }
 }
@@ -3,9 +3,23 @@
 // (See accompanying file LICENSE_1_0.txt or copy at
 // http://www.boost.org/LICENSE_1_0.txt)
 
-#include "wildcards/matcher.hpp"  // wildcards::literals, wildcards::make_matcher
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t
+#include <iterator>     // std::back_inserter
+#include <string>       // std::string
+#include <type_traits>  // std::is_same
+#include <vector>       // std::vector
+
+#include "wildcards/matcher.hpp"  // wildcards::cards, wildcards::compile, wildcards::compile_errc,
+                                  // wildcards::extended_cards, wildcards::literals,
+                                  // wildcards::make_lazy_matcher, wildcards::make_matcher,
+                                  // wildcards::make_static_matcher, wildcards::match,
+                                  // wildcards::matcher, wildcards::prefilter_stats,
+                                  // wildcards::static_cards
 #include "cx/array.hpp"           // cx::array
-#include "cx/string_view.hpp"     // cx::literals
+#include "cx/functional.hpp"      // cx::equal_to
+#include "cx/string_view.hpp"     // cx::literals, cx::string_view, cx::u16string_view
+#include "wildcards/memo.hpp"     // wildcards::memo_buffer
 
 #include "catch.hpp"
 
@@ -27,6 +41,53 @@ TEST_CASE("wildcards::matcher is compliant", "[wildcards::matcher]")
     static_assert(pattern.matches("Hello, World!"), "");
   }
 
+  SECTION(R"(matching "H_llo,%W%!" using static cards)")
+  {
+    using wildcards::static_cards;
+
+    constexpr auto pattern = make_matcher("H_llo,%W%!", static_cards<char, '%', '_', '\\'>());
+
+    static_assert(pattern.matches("Hello, World!"), "");
+  }
+
+  SECTION("making matchers using the default cards")
+  {
+    using wildcards::cards;
+    using wildcards::compile;
+    using wildcards::extended_cards;
+    using wildcards::make_static_matcher;
+    using namespace wildcards::literals;
+
+    static_assert(std::is_same<decltype(make_matcher("a*")),
+                               decltype(make_matcher("a*", extended_cards<char>()))>::value,
+                  "");
+    static_assert(std::is_same<decltype(make_static_matcher("a*")),
+                               decltype(make_matcher("a*", extended_cards<char>()))>::value,
+                  "");
+    static_assert(std::is_same<decltype(compile("a*").m),
+                               decltype(make_matcher("a*", extended_cards<char>()))>::value,
+                  "");
+    static_assert(
+        std::is_same<decltype("a*"_wc),
+                     decltype(make_matcher(cx::string_view{}, extended_cards<char>()))>::value,
+        "");
+    static_assert(std::is_same<decltype(u"a*"_wc),
+                               decltype(make_matcher(cx::u16string_view{},
+                                                     extended_cards<char16_t>()))>::value,
+                  "");
+
+    // Runtime cards stay runtime cards, even the default ones.
+    static_assert(
+        std::is_same<decltype(make_matcher("a*", cards<char>())),
+                     wildcards::matcher<const char(&)[3], cx::equal_to<void>, cards<char>>>::value,
+        "");
+
+    constexpr auto pattern = make_matcher("H?llo,*W*!");
+
+    static_assert(pattern.matches("Hello, World!"), "");
+    static_assert(!pattern.matches("Hello, World?"), "");
+  }
+
   SECTION(R"(matching "11*7?"_sv)")
   {
     struct equal_to
@@ -116,4 +177,219 @@ TEST_CASE("wildcards::matcher is compliant", "[wildcards::matcher]")
     static_assert(pattern.matches(L"Hello, World!"), "");
 #endif
   }
+
+  SECTION(R"zzz(matching "*.[hc](pp|)" at runtime)zzz")
+  {
+    const auto pattern = make_matcher("*.[hc](pp|)");
+
+    REQUIRE(pattern.matches("source.c"));
+    REQUIRE(pattern.matches("source.hpp"));
+    REQUIRE(!pattern.matches("source.cc"));
+    REQUIRE(!pattern.matches("source.cp"));
+  }
+
+  SECTION(R"(testing "H?llo,*W*!")")
+  {
+    constexpr auto pattern = make_matcher("H?llo,*W*!");
+
+    static_assert(pattern.test("Hello, World!"), "");
+    static_assert(!pattern.test("Hello World!"), "");
+  }
+
+  SECTION(R"zzz(testing "*.[hc](pp|)" at runtime)zzz")
+  {
+    const auto pattern = make_matcher("*.[hc](pp|)");
+
+    REQUIRE(pattern.test("source.c"));
+    REQUIRE(pattern.test("source.hpp"));
+    REQUIRE(!pattern.test("source.cc"));
+    REQUIRE(!pattern.test("source.cp"));
+  }
+
+  SECTION(R"zzz(compiling "*.[hc](pp|)")zzz")
+  {
+    using wildcards::compile;
+
+    constexpr auto result = compile("*.[hc](pp|)");
+
+    static_assert(result, "");
+    static_assert(result.m.matches("source.hpp"), "");
+    static_assert(noexcept(result.m.matches("source.hpp")), "");
+  }
+
+  SECTION("compiling patterns ending with an escape")
+  {
+    using wildcards::compile;
+    using wildcards::compile_errc;
+    using wildcards::match;
+
+    using namespace cx::literals;
+
+    constexpr auto result = compile(R"([\]a\)"_sv);
+
+    static_assert(result, "");
+    static_assert(result.error.code == compile_errc::none, "");
+    static_assert(result.m.matches(R"(\a)"_sv), "");
+    static_assert(!result.m.matches(R"(\a\)"_sv), "");
+    static_assert(match(R"(\a)"_sv, R"([\]a\)"_sv), "");
+
+    const auto m = make_matcher(R"(ab\)"_sv);
+
+    REQUIRE(m.compiled());
+    REQUIRE(m.matches("ab"_sv));
+    REQUIRE(match("ab"_sv, R"(ab\)"_sv));
+    REQUIRE(!m.matches(R"(ab\)"_sv));
+  }
+
+  SECTION("compiling patterns too long for a program")
+  {
+    using wildcards::compile;
+
+    const auto complex = compile("?????????????????????????????????????????????"
+                                 "????????????????????????????????????????????");
+
+    REQUIRE(complex);
+    REQUIRE(!complex.m.compiled());
+    REQUIRE(!complex.m.matches("short"));
+    REQUIRE(complex.m.matches(std::string(89, 'x') + '\0'));
+    REQUIRE(!complex.m.matches(std::string(90, 'x') + '\0'));
+    REQUIRE(compile("*.[hc](pp|)").m.compiled());
+  }
+
+  SECTION(R"zzz(matching "*.[hc](pp|)" statically)zzz")
+  {
+    using wildcards::make_static_matcher;
+    using wildcards::static_cards;
+
+    constexpr auto pattern = make_static_matcher("*.[hc](pp|)");
+
+    static_assert(!pattern.error(), "");
+    static_assert(pattern.matches("source.hpp"), "");
+    static_assert(!pattern.matches("source.cc"), "");
+
+    static constexpr auto standard =
+        make_static_matcher("*.[hc](pp|)", static_cards<char, '%', '_', '\\'>());
+
+    REQUIRE(standard.matches("*.[hc](pp|)"));
+    REQUIRE(!standard.matches("source.hpp"));
+  }
+
+  SECTION("matching in batches at runtime")
+  {
+    const cx::string_view patterns[] = {"",           "*",         "abc",          "a*",
+                                        "*c",         "a?c*",      "*[bc]?[!a]*",  "*[!ab]",
+                                        "*b*b*",      "(a|bc)*",   "[abcdefghij]*", "*\\*a"};
+
+    std::vector<std::string> sequences;
+
+    for (std::size_t i = 0; i != 150; ++i)
+    {
+      std::string sequence;
+
+      for (auto n = i; n != 0; n /= 5)
+      {
+        sequence += "abc*\xff"[n % 5];
+      }
+
+      sequences.push_back(sequence);
+    }
+
+    for (const auto& p : patterns)
+    {
+      const auto pattern = make_matcher(p);
+
+      std::vector<std::uint64_t> masks;
+
+      pattern.matches_batch(sequences, std::back_inserter(masks));
+
+      REQUIRE(masks.size() == 3);
+
+      for (std::size_t i = 0; i != sequences.size(); ++i)
+      {
+        INFO("pattern: " << p << ", sequence: " << sequences[i]);
+        REQUIRE((((masks[i / 64] >> (i % 64)) & 1) != 0) == pattern.test(sequences[i]));
+      }
+
+      REQUIRE(masks[2] >> (sequences.size() % 64) == 0);
+    }
+  }
+
+  SECTION(R"(matching "*(ab|ba)*c" lazily at runtime)")
+  {
+    using wildcards::make_lazy_matcher;
+
+    auto pattern = make_lazy_matcher(make_matcher("*(ab|ba)*c"));
+
+    REQUIRE(pattern.matches("xxbaxxc"));
+    REQUIRE(pattern.matches("abc"));
+    REQUIRE(!pattern.matches("aacbb"));
+    REQUIRE(!pattern.matches("abba"));
+    REQUIRE(pattern.states() > 2);
+  }
+
+  SECTION(R"zzz(matching "(*a|*b)*(c|*d)" with a memo at runtime)zzz")
+  {
+    using wildcards::memo_buffer;
+
+    const auto pattern = make_matcher("(*a|*b)*(c|*d)");
+
+    memo_buffer memo;
+
+    REQUIRE(pattern.matches("xxbyyc", memo));
+    REQUIRE(pattern.matches("aad", memo));
+
+    const auto sequence = cx::string_view{"aaaaaaaaaaaaaaaaaaaaaaaa"};
+    const auto result = pattern.matches(sequence, memo);
+    const auto expected = pattern.matches(sequence);
+
+    REQUIRE(!result);
+    REQUIRE(result.s1 == expected.s1);
+    REQUIRE(result.p1 == expected.p1);
+  }
+
+  SECTION("matching a pattern too long to compile with a memo at runtime")
+  {
+    using wildcards::memo_buffer;
+
+    using namespace cx::literals;
+
+    const auto pattern = make_matcher(
+        "(*a|*b)(*a|*b)(*a|*b)(*a|*b)(*a|*b)(*a|*b)(*a|*b)(*a|*b)(*a|*b)(*a|*b)c"_sv);
+
+    REQUIRE(!pattern.compiled());
+
+    memo_buffer memo;
+
+    REQUIRE(pattern.matches("xaxbaaaaaaaabc"_sv, memo));
+    REQUIRE(pattern.matches("aaaaaaaaaac"_sv, memo));
+    REQUIRE(!pattern.matches("aaaaaaaaac"_sv, memo));
+
+    const auto short_sequence = "aaaaaaaaaaaaaa"_sv;
+    const auto result = pattern.matches(short_sequence, memo);
+    const auto expected = pattern.matches(short_sequence);
+
+    REQUIRE(!result);
+    REQUIRE(result.s1 == expected.s1);
+    REQUIRE(result.p1 == expected.p1);
+
+    // Scanning without the memo would try each way to split the sequence between the anythings.
+    REQUIRE(!pattern.matches("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"_sv,
+                             memo));
+  }
+
+  SECTION(R"(matching "*ERROR*timeout*" at runtime)")
+  {
+    using wildcards::prefilter_stats;
+
+    const auto pattern = make_matcher("*ERROR*timeout*");
+
+    prefilter_stats stats;
+
+    REQUIRE(pattern.matches("[ERROR] read timeout", stats));
+    REQUIRE(!pattern.matches("[ERROR] read failed", stats));
+    REQUIRE(!pattern.matches("[INFO] read timeout", stats));
+    REQUIRE(!pattern.matches("timeout", stats));
+    REQUIRE(stats.checks == 4);
+    REQUIRE(stats.rejections == 2);
+  }
 }
@@ -0,0 +1,98 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <iterator>  // std::back_inserter
+#include <string>    // std::string
+
+#include "wildcards/normalize.hpp"  // wildcards::normalize
+#include "cx/string_view.hpp"       // cx::string_view
+#include "wildcards/cards.hpp"      // wildcards::cards, wildcards::cards_type
+#include "wildcards/match.hpp"      // wildcards::match
+
+#include "catch.hpp"
+
+namespace
+{
+
+std::string normalized(cx::string_view pattern,
+                       const wildcards::cards<char>& c = wildcards::cards<char>())
+{
+  std::string result;
+
+  wildcards::normalize(pattern, std::back_inserter(result), c);
+
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("wildcards::normalize() is compliant", "[wildcards::normalize]")
+{
+  using wildcards::cards_type;
+  using wildcards::match;
+
+  SECTION("normalizing patterns")
+  {
+    struct
+    {
+      cx::string_view pattern;
+      cx::string_view expected;
+    } patterns[] = {{"", ""},
+                    {"**", "*"},
+                    {"*?*", "?*"},
+                    {"?*?**a", "??*a"},
+                    {R"(\a\*b\)", R"(a\*b)"},
+                    {"[a]", "a"},
+                    {"[aa]b", "ab"},
+                    {"[*]", R"(\*)"},
+                    {"[]]", "]"},
+                    {"[!a]", "[!a]"},
+                    {"[ab]", "[ab]"},
+                    {"(abc)", "abc"},
+                    {"((a|b))c", "(a|b)c"},
+                    {"(a?|bc)", "(a?|bc)"},
+                    {"(a*)b", "(a*)b"},
+                    {"(a**|[b]|)", "(a*|b|)"},
+                    {"(a|bc)", "(a|bc)"},
+                    {"a()a", "aa"},
+                    {"*(?)*", "?*"},
+                    {"?(*a)", "?(*a)"},
+                    {"(?)*(?)", "??*"},
+                    {"(?|*)*", "(?|*)*"},
+                    {"a[!]a", R"(a\[!]a)"}};
+
+    for (const auto& p : patterns)
+    {
+      INFO("pattern: " << p.pattern);
+      REQUIRE(normalized(p.pattern) == std::string(p.expected.begin(), p.expected.end()));
+    }
+  }
+
+  SECTION("normalizing patterns using standard cards")
+  {
+    REQUIRE(normalized("[a](b)**", cards_type::standard) == "[a](b)*");
+    REQUIRE(normalized(R"(\[\*)", cards_type::standard) == R"([\*)");
+  }
+
+  SECTION("matching the same sequences")
+  {
+    cx::string_view patterns[] = {"*?*",   "?*?",       "a?*?b",   "[a]*(b)", "(ab|[c])*",
+                                  "(a*)b", "((a|b))*c", "[!a]**b", R"(\a\)",
+                                  "*(?)*"};
+
+    cx::string_view sequences[] = {"", "a", "ab", "aab", "abab", "acb", "cab", "aXbc", "ba"};
+
+    for (const auto& p : patterns)
+    {
+      auto n = normalized(p);
+
+      for (const auto& s : sequences)
+      {
+        INFO("pattern: " << p << ", sequence: " << s);
+        REQUIRE(bool(match(s, n)) == bool(match(s, p)));
+      }
+    }
+  }
+}
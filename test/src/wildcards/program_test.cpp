@@ -0,0 +1,366 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include "wildcards/program.hpp"  // wildcards::detail::bitmap_index, wildcards::detail::opcode,
+                                  // wildcards::detail::program_shape,
+                                  // wildcards::detail::set_capacity,
+                                  // wildcards::detail::shift_and_state
+#include "cx/functional.hpp"      // cx::equal_to
+#include "cx/iterator.hpp"        // cx::begin, cx::end
+#include "cx/string_view.hpp"     // cx::literals, cx::string_view
+#include "wildcards/cards.hpp"    // wildcards::cards, wildcards::cards_type
+#include "wildcards/match.hpp"    // wildcards::detail::compile_program,
+                                  // wildcards::detail::compile_tables, wildcards::detail::match,
+                                  // wildcards::detail::run_memoized_program,
+                                  // wildcards::detail::run_program,
+                                  // wildcards::detail::test_engine
+#include "wildcards/memo.hpp"     // wildcards::memo_buffer
+
+#include "catch.hpp"
+
+TEST_CASE("wildcards::detail::compile_program() is compliant",
+          "[wildcards::detail::compile_program]")
+{
+  using wildcards::cards;
+  using wildcards::cards_type;
+  using wildcards::detail::bitmap_index;
+  using wildcards::detail::compile_program;
+  using wildcards::detail::compile_tables;
+  using wildcards::detail::opcode;
+  using wildcards::detail::set_capacity;
+
+  SECTION("compiling literals")
+  {
+    char pattern[] = R"(ab\*c\)";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+
+    REQUIRE(prog.valid());
+    REQUIRE(prog.size() == 2);
+    REQUIRE(prog[0].op == opcode::literal);
+    REQUIRE(prog[0].first == 0);
+    REQUIRE(prog[0].last == 2);
+    REQUIRE(prog[1].op == opcode::literal);
+    REQUIRE(prog[1].first == 3);
+    REQUIRE(prog[1].last == 5);
+  }
+
+  SECTION("compiling cards")
+  {
+    char pattern[] = "a*?[!]x]";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+
+    REQUIRE(prog.valid());
+    REQUIRE(prog.size() == 4);
+    REQUIRE(prog[1].op == opcode::single);
+    REQUIRE(prog[1].first == 1);
+    REQUIRE(prog[2].op == opcode::anything);
+    REQUIRE(prog[2].first == 1);
+    REQUIRE(prog[3].op == opcode::set);
+    REQUIRE(prog[3].negated);
+    REQUIRE(prog[3].first == 5);
+    REQUIRE(prog[3].last == 7);
+  }
+
+  SECTION("compiling alternatives")
+  {
+    char pattern[] = "(a|(b|c)|)";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+
+    REQUIRE(prog.valid());
+    REQUIRE(prog.size() == 10);
+    REQUIRE(prog[0].op == opcode::alt_open);
+    REQUIRE(prog[0].next == 2);
+    REQUIRE(prog[0].close == 9);
+    REQUIRE(prog[2].op == opcode::alt_or);
+    REQUIRE(prog[2].next == 8);
+    REQUIRE(prog[2].close == 9);
+    REQUIRE(prog[3].op == opcode::alt_open);
+    REQUIRE(prog[3].next == 5);
+    REQUIRE(prog[3].close == 7);
+    REQUIRE(prog[7].op == opcode::alt_close);
+    REQUIRE(prog[8].op == opcode::alt_or);
+    REQUIRE(prog[8].next == 9);
+    REQUIRE(prog[9].op == opcode::alt_close);
+  }
+
+  SECTION("compiling unclosed alternatives")
+  {
+    char pattern[] = "(a(b|c)|d";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+
+    REQUIRE(prog.valid());
+    REQUIRE(prog.has_alt());
+    REQUIRE(prog.size() == 7);
+    REQUIRE(prog[0].op == opcode::literal);
+    REQUIRE(prog[0].first == 0);
+    REQUIRE(prog[0].last == 2);
+    REQUIRE(prog[1].op == opcode::alt_open);
+    REQUIRE(prog[1].next == 3);
+    REQUIRE(prog[1].close == 5);
+    REQUIRE(prog[5].op == opcode::alt_close);
+    REQUIRE(prog[6].op == opcode::literal);
+    REQUIRE(prog[6].first == 7);
+    REQUIRE(prog[6].last == 9);
+  }
+
+  SECTION("compiling sets into bitmaps")
+  {
+    char pattern[] = "[a\xff][!b]";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+
+    REQUIRE(prog.valid());
+    REQUIRE(prog.size() == 2);
+    REQUIRE(prog[0].next != set_capacity);
+    REQUIRE(prog.bitmap(prog[0].next).contains('a'));
+    REQUIRE(prog.bitmap(prog[0].next).contains('\xff'));
+    REQUIRE(!prog.bitmap(prog[0].next).contains('b'));
+    REQUIRE(prog.bitmap(prog[0].next).size() == 2);
+    REQUIRE(prog.bitmap(prog[0].next).members()[0] == 'a');
+    REQUIRE(prog.bitmap(prog[0].next).members()[1] == 0xff);
+    REQUIRE(prog[1].next != set_capacity);
+    REQUIRE(prog.bitmap(prog[1].next).contains('a'));
+    REQUIRE(!prog.bitmap(prog[1].next).contains('b'));
+    REQUIRE(prog.bitmap(prog[1].next).size() == 255);
+  }
+
+  SECTION("compiling wide sets into bitmaps")
+  {
+    char32_t pattern[] = U"[a][!b][a\U0001F600]";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char32_t>());
+
+    REQUIRE(prog.valid());
+    REQUIRE(prog.size() == 3);
+    REQUIRE(prog.bitmap(prog[0].next).contains(U'a'));
+    REQUIRE(!prog.bitmap(prog[0].next).contains(U'\u0161'));
+    REQUIRE(prog.bitmap(prog[1].next).contains(U'\u0161'));
+    REQUIRE(!prog.bitmap(prog[1].next).contains(U'b'));
+    REQUIRE(prog[2].next == set_capacity);
+  }
+
+  SECTION("measuring patterns")
+  {
+    char pattern[] = R"(ab*c?(d|ef|)[gh]*i\*j)";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+
+    REQUIRE(prog.valid());
+    REQUIRE(prog.min_length() == 8);
+    REQUIRE(prog[prog.suffix()].op == opcode::literal);
+    REQUIRE(prog[prog.suffix() - 1].op == opcode::anything);
+    REQUIRE(prog.suffix_length() == 3);
+  }
+
+  SECTION("finding required literals")
+  {
+    char pattern[] = R"(a*bc*d\ef?gh*i)";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+
+    REQUIRE(prog.valid());
+    REQUIRE(prog.required_length() == 3);
+    REQUIRE(prog[prog.required()].first == 5);
+    REQUIRE(prog.required_end() - prog.required() == 2);
+
+    auto tables = compile_tables(prog, cx::begin(pattern));
+
+    REQUIRE(tables.has_skip());
+    REQUIRE(tables.skip('d') == 2);
+    REQUIRE(tables.skip('e') == 1);
+    REQUIRE(tables.skip('f') == 3);
+    REQUIRE(tables.skip('x') == 3);
+  }
+
+  SECTION("finding no required literals")
+  {
+    char pattern[] = "ab*(c|d)*e";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+
+    REQUIRE(prog.valid());
+    REQUIRE(prog.required_length() == 0);
+  }
+
+  SECTION("compiling Shift-And masks")
+  {
+    char pattern[] = "ab*c?[de]*f";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+
+    REQUIRE(prog.valid());
+
+    auto tables = compile_tables(prog, cx::begin(pattern));
+
+    REQUIRE(tables.has_shift_and());
+
+    auto state = tables.shift_and_start();
+
+    for (auto c : cx::string_view{"zcxezf"})
+    {
+      state = tables.shift_and_step(state, bitmap_index(c));
+    }
+
+    REQUIRE(tables.shift_and_accepts(state));
+    REQUIRE(!tables.shift_and_accepts(tables.shift_and_step(state, bitmap_index('c'))));
+  }
+
+  SECTION("compiling Shift-And masks of several words")
+  {
+    using wildcards::detail::shift_and_state;
+
+    using namespace cx::literals;
+
+    auto pattern =
+        "*0123456789[ab]0123456789?0123456789*0123456789012345678901234567890123456789*z"_sv;
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern), cards<char>());
+
+    REQUIRE(prog.valid());
+
+    auto tables = compile_tables(prog, cx::begin(pattern));
+
+    REQUIRE(tables.has_shift_and());
+    REQUIRE(tables.shift_and_size() == 2);
+
+    shift_and_state state{};
+
+    tables.shift_and_start(state);
+
+    for (auto c :
+         "x0123456789b0123456789x0123456789yy0123456789012345678901234567890123456789yyz"_sv)
+    {
+      tables.shift_and_step(state, bitmap_index(c));
+    }
+
+    REQUIRE(tables.shift_and_accepts(state));
+
+    tables.shift_and_step(state, bitmap_index('y'));
+
+    REQUIRE(!tables.shift_and_accepts(state));
+  }
+
+  SECTION("compiling no Shift-And masks for alternatives")
+  {
+    char pattern[] = "*(a|b)";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+
+    REQUIRE(prog.valid());
+    REQUIRE(!compile_tables(prog, cx::begin(pattern)).has_shift_and());
+  }
+
+  SECTION("classifying patterns")
+  {
+    using wildcards::detail::program_shape;
+
+    struct
+    {
+      cx::string_view pattern;
+      program_shape shape;
+    } patterns[] = {{R"(ab\*)", program_shape::exact},       {"ab*", program_shape::prefix},
+                    {"*", program_shape::prefix},            {"*ab", program_shape::suffix},
+                    {"a*b", program_shape::prefix_suffix},   {"*ab*", program_shape::contains},
+                    {"**", program_shape::prefix},           {"*a*b*", program_shape::general},
+                    {"a?", program_shape::general},          {"(a|b)*", program_shape::general}};
+
+    for (const auto& p : patterns)
+    {
+      INFO("pattern: " << p.pattern);
+      REQUIRE(compile_program(p.pattern.begin(), p.pattern.end(), cards<char>()).shape() ==
+              p.shape);
+    }
+  }
+
+  SECTION("compiling using standard cards")
+  {
+    char pattern[] = "[a](b)";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards_type::standard);
+
+    REQUIRE(prog.valid());
+    REQUIRE(prog.size() == 1);
+    REQUIRE(prog[0].op == opcode::literal);
+  }
+
+  SECTION("compiling too complex patterns")
+  {
+    char pattern[] = "?????????????????????????????????????????????????????????????????????";
+
+    auto prog = compile_program(cx::begin(pattern), cx::end(pattern) - 1, cards<char>());
+
+    REQUIRE(!prog.valid());
+  }
+}
+
+TEST_CASE("wildcards::detail::run_program() is compliant", "[wildcards::detail::run_program]")
+{
+  using wildcards::cards;
+  using wildcards::detail::compile_program;
+  using wildcards::detail::compile_tables;
+  using wildcards::detail::match;
+  using wildcards::memo_buffer;
+  using wildcards::detail::run_memoized_program;
+  using wildcards::detail::run_program;
+  using wildcards::detail::test_engine;
+
+  cx::string_view patterns[] = {
+      "",        "A",          R"(A\)",     R"(\*)",      "*",          "?",         "H?llo,*W*!",
+      "*a*a*b",  "[abc]*",     "[!abc]?",   "a[]]a",      "a[!]a",      "a(X|Y)b",   "(a(X|Y)b|c)",
+      "a|b",     "(a(a|b)",    "(a[(]a|b)", "a()a",       "(abc|)",     "*.[hc](pp|)", "(*a|b)c",
+      "((a|ab)|x)c",           "*[0123456789abcdef]",     "[!]]*",      "[!]a]?",
+      "ab*cd",                 "*.cpp",                   "so*.*p",     "s?*e.*",
+      "*ll*o*",                "*o*r*",                   "*W\\or?*",  "*user=*",
+      "a**b?",                 "*[!abc]*?d",              "(*a|*b)*(c|*d)",
+      "*ll*",                  "He*",                     "*?*",        "?*?",
+      "a?*?b",                 "*[hc]?p",                 "*[!a]"};
+
+  cx::string_view sequences[] = {"",         "A",      "a",      "*",          "Hello, World!",
+                                 "aaaab",    "aaaaa",  "cab",    "xy",         "a]a",
+                                 "a!a",      "aXb",    "aZb",    "c",          "a|b",
+                                 "(aa",      "a(a",    "aa",     "abc",        "source.cpp",
+                                 "source.h", "bc",     "abc",    "xc",         "ac",
+                                 "abxcd",    "abcd",   "abd",    ".cpp",       "scpp",
+                                 "id=1 user=root",     "username"};
+
+  memo_buffer memo;
+
+  for (const auto& p : patterns)
+  {
+    auto prog = compile_program(p.begin(), p.end(), cards<char>());
+    auto tables = compile_tables(prog, p.begin());
+
+    REQUIRE(prog.valid());
+
+    for (const auto& s : sequences)
+    {
+      auto expected = match(s.begin(), s.end(), p.begin(), p.end(), cards<char>(),
+                            cx::equal_to<void>());
+      auto result = run_program(prog, s.begin(), s.end(), p.begin(), cx::equal_to<void>());
+      auto fast =
+          run_program(prog, s.begin(), s.end(), p.begin(), cx::equal_to<void>(), &tables);
+      auto memoized = run_memoized_program(prog, s.begin(), s.end(), p.begin(),
+                                           cx::equal_to<void>(), &tables, memo);
+      auto tested = run_program<test_engine>(prog, s.begin(), s.end(), p.begin(),
+                                             cx::equal_to<void>(), &tables);
+
+      INFO("pattern: " << p << ", sequence: " << s);
+      REQUIRE(result.res == expected.res);
+      REQUIRE(result.s == expected.s);
+      REQUIRE(result.p == expected.p);
+      REQUIRE(fast.res == expected.res);
+      REQUIRE(fast.s == expected.s);
+      REQUIRE(fast.p == expected.p);
+      REQUIRE(memoized.res == expected.res);
+      REQUIRE(memoized.s == expected.s);
+      REQUIRE(memoized.p == expected.p);
+      REQUIRE(tested.res == expected.res);
+    }
+  }
+}
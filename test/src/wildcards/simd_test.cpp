@@ -0,0 +1,115 @@
+// Copyright Tomas Zeman 2019.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint8_t
+#include <string>   // std::string
+
+#include "wildcards/simd.hpp"     // wildcards::active_simd_level, wildcards::detail::find_any_byte,
+                                  // wildcards::detail::find_any_byte_scalar,
+                                  // wildcards::detected_simd_level, wildcards::force_simd_level,
+                                  // wildcards::simd_level
+#include "cx/array.hpp"           // cx::array
+#include "cx/string_view.hpp"     // cx::literals
+#include "wildcards/matcher.hpp"  // wildcards::make_matcher
+
+#include "catch.hpp"
+
+TEST_CASE("wildcards::force_simd_level() is compliant", "[wildcards::force_simd_level]")
+{
+  using wildcards::active_simd_level;
+  using wildcards::detected_simd_level;
+  using wildcards::force_simd_level;
+  using wildcards::simd_level;
+
+  const cx::array<simd_level, 4> levels = {
+      {simd_level::scalar, simd_level::sse2, simd_level::avx2, simd_level::avx512}};
+
+  SECTION("forcing levels")
+  {
+    for (auto level : levels)
+    {
+      auto forced = force_simd_level(level);
+
+      REQUIRE(forced <= level);
+      REQUIRE(forced <= detected_simd_level());
+      REQUIRE(active_simd_level() == forced);
+    }
+
+    REQUIRE(force_simd_level(simd_level::scalar) == simd_level::scalar);
+  }
+
+  SECTION("finding bytes at every level")
+  {
+    using wildcards::detail::find_any_byte;
+    using wildcards::detail::find_any_byte_scalar;
+
+    std::uint8_t buffer[200];
+
+    for (std::size_t i = 0; i != sizeof(buffer); ++i)
+    {
+      buffer[i] = static_cast<std::uint8_t>(i * 7 % 64);
+    }
+
+    buffer[150] = 0xff;
+    buffer[190] = 0x80;
+
+    const std::uint8_t bytes[] = {0xff, 0x80, 63, 5, 200, 201, 202, 0};
+
+    for (auto level : levels)
+    {
+      INFO("level: " << static_cast<int>(force_simd_level(level)));
+
+      for (std::size_t count = 0; count <= sizeof(bytes); ++count)
+      {
+        for (std::size_t first = 0; first < 70; first += 3)
+        {
+          for (std::size_t last = first; last <= sizeof(buffer); last += 13)
+          {
+            INFO("count: " << count << ", first: " << first << ", last: " << last);
+            REQUIRE(find_any_byte(buffer + first, buffer + last, bytes, count) ==
+                    find_any_byte_scalar(buffer + first, buffer + last, bytes, count));
+          }
+        }
+      }
+    }
+  }
+
+  SECTION("matching at every level")
+  {
+    using wildcards::make_matcher;
+
+    using namespace cx::literals;
+
+    const auto pattern = make_matcher("*[xyz]*[!abcdefghijklmnopqrstuvwxyz]*"_sv);
+
+    std::string sequence(100, 'a');
+
+    for (auto level : levels)
+    {
+      INFO("level: " << static_cast<int>(force_simd_level(level)));
+
+      REQUIRE(!pattern.matches(sequence));
+
+      sequence[70] = 'y';
+
+      REQUIRE(!pattern.matches(sequence));
+
+      sequence[90] = '\xff';
+
+      REQUIRE(pattern.matches(sequence));
+      REQUIRE(pattern.matches(sequence).s1 == sequence.cend());
+
+      sequence[70] = 'a';
+
+      REQUIRE(!pattern.matches(sequence));
+      REQUIRE(pattern.matches(sequence).p1 == pattern.matches(std::string(100, 'a')).p1);
+
+      sequence[90] = 'a';
+    }
+  }
+
+  force_simd_level(detected_simd_level());
+}